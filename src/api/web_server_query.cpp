@@ -35,7 +35,7 @@ namespace bumo {
 		Json::Value record = Json::Value(Json::arrayValue);
 		Json::Value &result = reply_json["result"];
 
-		if (!Environment::AccountFromDB(address, acc)) {
+		if (!LedgerManager::Instance().GetStateView()->AccountFromDB(address, acc)) {
 			error_code = protocol::ERRCODE_NOT_EXIST;
 			LOG_TRACE("GetAccount fail, account(%s) not exist", address.c_str());
 		}
@@ -68,7 +68,7 @@ namespace bumo {
 		Json::Value record = Json::Value(Json::arrayValue);
 		Json::Value &result = reply_json["result"];
 
-		if (!Environment::AccountFromDB(address, acc)) {
+		if (!LedgerManager::Instance().GetStateView()->AccountFromDB(address, acc)) {
 			error_code = protocol::ERRCODE_NOT_EXIST;
 			LOG_TRACE("GetAccount fail, account(%s) not exist", address.c_str());
 		}
@@ -133,7 +133,7 @@ namespace bumo {
 		Json::Value record = Json::Value(Json::arrayValue);
 		Json::Value &result = reply_json["result"];
 
-		if (!Environment::AccountFromDB(address, acc)) {
+		if (!LedgerManager::Instance().GetStateView()->AccountFromDB(address, acc)) {
 			error_code = protocol::ERRCODE_NOT_EXIST;
 			LOG_TRACE("account(%s) not exist", address.c_str());
 		}
@@ -189,7 +189,7 @@ namespace bumo {
 		Json::Value record = Json::Value(Json::arrayValue);
 		Json::Value &result = reply_json["result"];
 
-		if (!Environment::AccountFromDB(address, acc)) {
+		if (!LedgerManager::Instance().GetStateView()->AccountFromDB(address, acc)) {
 			error_code = protocol::ERRCODE_NOT_EXIST;
 			LOG_TRACE("GetAccount fail, account(%s) not exist", address.c_str());
 		}
@@ -789,7 +789,16 @@ namespace bumo {
 		Json::Value &result = reply_json["result"];
 
 		do {
-			if (!Environment::AccountFromDB(address, acc)) {
+			//the same query on the same ledger returns the same result, keyed on the ledger of the state read
+			StateView::pointer state_view = LedgerManager::Instance().GetStateView();
+			ContractQueryCache &query_cache = LedgerManager::Instance().query_cache_;
+			int64_t version = state_view->GetHeader().seq();
+			std::string key = ContractQueryCache::GetKey(address, args);
+			if (query_cache.Get(key, version, result)) {
+				break;
+			}
+
+			if (!state_view->AccountFromDB(address, acc)) {
 				error_code = protocol::ERRCODE_NOT_EXIST;
 				error_desc = utils::String::Format("Account(%s) not exist", address.c_str());
 				LOG_ERROR("%s", error_desc.c_str());
@@ -804,16 +813,14 @@ namespace bumo {
 				break;
 			}
 
-			ContractParameter parameter;
-			parameter.code_ = code;
-			parameter.input_ = args;
-// 			if (!ContractManager::Instance().Query(Contract::TYPE_V8, parameter, result)) {
-// 				error_code = protocol::ERRCODE_CONTRACT_EXECUTE_FAIL;
-// 				error_desc = utils::String::Format("Account(%s) contract executed failed", address.c_str());
-// 				LOG_ERROR("%s", error_desc.c_str());
-// 				break;
-// 			}
+			if (!LedgerManager::Instance().context_manager_.SyncQueryProcess(address, code, args, state_view, utils::MICRO_UNITS_PER_SEC, result)) {
+				error_code = protocol::ERRCODE_CONTRACT_EXECUTE_FAIL;
+				error_desc = utils::String::Format("Account(%s) contract executed failed", address.c_str());
+				LOG_ERROR("%s", error_desc.c_str());
+				break;
+			}
 
+			query_cache.Set(key, version, result);
 		} while (false);
 
 		reply_json["error_code"] = error_code;
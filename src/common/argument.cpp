@@ -388,7 +388,7 @@ namespace bumo {
 #ifdef WIN32
 				ledger_db_ = new LevelDbDriver();
 #else
-				ledger_db_ = new RocksDbDriver();
+				ledger_db_ = new RocksDbDriver(DbTuning(), nullptr, Storage::LedgerColumnFamilies());
 #endif
 				if (!ledger_db_->Open(path, -1)) {
 					return false;
@@ -19,6 +19,27 @@
 #include "configure_base.h"
 
 namespace bumo {
+	DbTuning::DbTuning() {
+		bloom_bits_per_key_ = 10;
+		write_buffer_size_ = 0;
+		max_write_buffer_number_ = 0;
+		column_families_ = true;
+	}
+
+	DbTuning::~DbTuning() {}
+
+	bool DbTuning::Load(const Json::Value &value) {
+		ConfigureBase::GetValue(value, "bloom_bits_per_key", bloom_bits_per_key_);
+		if (value.isMember("compression_per_level")) {
+			compression_per_level_.clear();
+			ConfigureBase::GetValue(value, "compression_per_level", compression_per_level_);
+		}
+		ConfigureBase::GetValue(value, "write_buffer_size", write_buffer_size_);
+		ConfigureBase::GetValue(value, "max_write_buffer_number", max_write_buffer_number_);
+		ConfigureBase::GetValue(value, "column_families", column_families_);
+		return true;
+	}
+
 	DbConfigure::DbConfigure() {
 		keyvalue_db_path_ = General::DEFAULT_KEYVALUE_DB_PATH;
 		ledger_db_path_ = General::DEFAULT_LEDGER_DB_PATH;
@@ -26,6 +47,9 @@ namespace bumo {
 		tmp_path_ = "tmp";
 		async_write_sql_ = false; //default sync write sql
 		async_write_kv_ = false; //default sync write kv
+		wal_sync_interval_ = 1000;
+		block_cache_size_ = 64 * utils::BYTES_PER_MEGA;
+		single_db_ = false;
 	}
 
 	DbConfigure::~DbConfigure() {}
@@ -40,7 +64,18 @@ namespace bumo {
 		ConfigureBase::GetValue(value, "tmp_path", tmp_path_);
 		ConfigureBase::GetValue(value, "async_write_sql", async_write_sql_);
 		ConfigureBase::GetValue(value, "async_write_kv", async_write_kv_);
-
+		ConfigureBase::GetValue(value, "wal_sync_interval", wal_sync_interval_);
+		ConfigureBase::GetValue(value, "single_db", single_db_);
+
+		//the tuning applies to all dbs, the keyvalue, ledger and account members override it for one db
+		const Json::Value &tuning = value["tuning"];
+		ConfigureBase::GetValue(tuning, "block_cache_size", block_cache_size_);
+		keyvalue_tuning_.Load(tuning);
+		keyvalue_tuning_.Load(tuning["keyvalue"]);
+		ledger_tuning_.Load(tuning);
+		ledger_tuning_.Load(tuning["ledger"]);
+		account_tuning_.Load(tuning);
+		account_tuning_.Load(tuning["account"]);
 
 		std::string rational_decode;
 		std::vector<std::string> nparas = utils::String::split(rational_string_, " ");
@@ -40,6 +40,20 @@ namespace bumo {
 		bool Load(const Json::Value &value);
 	};
 
+	//rocksdb options of a database, leveldb ignores them
+	class DbTuning {
+	public:
+		DbTuning();
+		~DbTuning();
+
+		int32_t bloom_bits_per_key_; //0 : no bloom filter
+		utils::StringList compression_per_level_; //none, snappy, zlib, bzip2, lz4, lz4hc. empty : rocksdb default
+		int64_t write_buffer_size_; //0 : rocksdb default
+		int32_t max_write_buffer_number_; //0 : rocksdb default
+		bool column_families_; //only takes effect when the db is created
+		bool Load(const Json::Value &value);
+	};
+
 	class DbConfigure {
 	public:
 		DbConfigure();
@@ -53,6 +67,13 @@ namespace bumo {
 		std::string tmp_path_;
 		bool async_write_sql_;
 		bool async_write_kv_;
+		int64_t wal_sync_interval_; //ms, the wal of the async keyvalue db writes is synced at this interval
+
+		int64_t block_cache_size_; //shared by all dbs, 0 : rocksdb default cache of each db
+		bool single_db_; //keep the ledger data in the account db, a ledger closes with one write. rocksdb only, fixed when the db is created
+		DbTuning keyvalue_tuning_;
+		DbTuning ledger_tuning_;
+		DbTuning account_tuning_;
 		bool Load(const Json::Value &value);
 	};
 
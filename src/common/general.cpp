@@ -74,6 +74,7 @@ namespace bumo {
 	const char *General::ACCOUNT_PREFIX = "acc";
 	const char *General::ASSET_PREFIX = "ast";
 	const char *General::METADATA_PREFIX = "meta";
+	const char *General::CONTRACT_CODE_CACHE_PREFIX = "code_cache";
 
 	const char *General::CHECK_TIME_FUNCTION = "internal_check_time";
 
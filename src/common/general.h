@@ -54,6 +54,8 @@ namespace bumo {
 
 		const static int TX_EXECUTE_TIME_OUT = utils::MICRO_UNITS_PER_SEC;
 		const static int BLOCK_EXECUTE_TIME_OUT = 5 * utils::MICRO_UNITS_PER_SEC;
+		//the proposer stops taking txs after this, one more tx still ends within BLOCK_EXECUTE_TIME_OUT
+		const static int BLOCK_PROPOSE_TIME_BUDGET = BLOCK_EXECUTE_TIME_OUT - 2 * TX_EXECUTE_TIME_OUT;
 
 		const static int LAST_TX_HASHS_LIMIT = 100;
 
@@ -90,6 +92,7 @@ namespace bumo {
 		const static char *ACCOUNT_PREFIX;
 		const static char *ASSET_PREFIX;
 		const static char *METADATA_PREFIX;
+		const static char *CONTRACT_CODE_CACHE_PREFIX;
 
 		const static char *CHECK_TIME_FUNCTION;
 
@@ -297,6 +297,50 @@ namespace bumo {
 		return false;
 	}
 
+	bool PublicKey::VerifyGroup(const std::vector<SignatureEntry> &entries, std::vector<bool> &valid) {
+		valid.assign(entries.size(), false);
+
+		std::vector<std::string> raw_pubkeys(entries.size());
+		std::vector<size_t> ed25519_index;
+		for (size_t i = 0; i < entries.size(); i++) {
+			const SignatureEntry &entry = entries[i];
+			PrivateKeyPrefix prefix;
+			SignatureType sign_type;
+			bool ok = GetPublicKeyElement(entry.encode_public_key_, prefix, sign_type, raw_pubkeys[i]);
+			if (!ok || prefix != PUBLICKEY_PREFIX || entry.signature_.size() != 64) {
+				continue;
+			}
+
+			if (sign_type == SIGNTYPE_ED25519) {
+				//a non canonical S is rejected as ed25519_sign_open does
+				if ((unsigned char)entry.signature_[63] & 224) {
+					continue;
+				}
+				ed25519_index.push_back(i);
+			}
+			else if (sign_type == SIGNTYPE_CFCASM2) {
+				valid[i] = utils::EccSm2::verify(utils::EccSm2::GetCFCAGroup(), raw_pubkeys[i], "1234567812345678", entry.data_, entry.signature_) == 1;
+			}
+			else {
+				LOG_ERROR("Unknown signature type(%d)", sign_type);
+			}
+		}
+
+		//not ed25519_sign_open_batch, its random batch equation accepts some signatures the single check
+		//rejects (small order components, non canonical R)
+		for (size_t j = 0; j < ed25519_index.size(); j++) {
+			const SignatureEntry &entry = entries[ed25519_index[j]];
+			const std::string &raw_pubkey = raw_pubkeys[ed25519_index[j]];
+			valid[ed25519_index[j]] = ed25519_sign_open((unsigned char *)entry.data_.c_str(), entry.data_.size(),
+				(unsigned char *)raw_pubkey.c_str(), (unsigned char *)entry.signature_.c_str()) == 0;
+		}
+
+		for (size_t i = 0; i < valid.size(); i++) {
+			if (!valid[i]) return false;
+		}
+		return true;
+	}
+
 	//ַǷϷ
 	PrivateKey::PrivateKey(SignatureType type) {
 		std::string raw_pub_key = "";
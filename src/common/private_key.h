@@ -62,6 +62,16 @@ namespace bumo {
 	SignatureType GetSignTypeByDesc(const std::string &desc);
 	
 
+	//one signature to be checked by PublicKey::VerifyGroup
+	struct SignatureEntry {
+		SignatureEntry(const std::string &data, const std::string &signature, const std::string &encode_public_key) :
+			data_(data), signature_(signature), encode_public_key_(encode_public_key) {}
+
+		std::string data_;
+		std::string signature_;
+		std::string encode_public_key_;
+	};
+
 	class PublicKey {
 		DISALLOW_COPY_AND_ASSIGN(PublicKey);
 		friend class PrivateKey;
@@ -84,6 +94,9 @@ namespace bumo {
 		SignatureType GetSignType() { return type_; };
 
 		static bool Verify(const std::string &data, const std::string &signature, const std::string &encode_public_key);
+		//checks every entry with Verify, it is not a batch check so an entry never passes with others that Verify rejects.
+		//valid[i] is the result of entries[i], return true if all are valid
+		static bool VerifyGroup(const std::vector<SignatureEntry> &entries, std::vector<bool> &valid);
 		static bool IsAddressValid(const std::string &encode_address);
 	private:
 		std::string raw_pub_key_;
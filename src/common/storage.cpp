@@ -17,15 +17,86 @@
 #include <utils/strings.h>
 #include <utils/logger.h>
 #include <utils/file.h>
+#ifndef WIN32
+#include <rocksdb/filter_policy.h>
+#include <rocksdb/slice_transform.h>
+#include <rocksdb/table.h>
+#endif
 #include "storage.h"
 #include "general.h"
 #define BUMO_ROCKSDB_MAX_OPEN_FILES 5000
 
 namespace bumo {
-	KeyValueDb::KeyValueDb() {}
+	KeyValueDb::KeyValueDb() :sync_write_(true), unsynced_count_(0) {}
 
 	KeyValueDb::~KeyValueDb() {}
 
+	void KeyValueDb::SetSyncWrite(bool sync_write) {
+		sync_write_ = sync_write;
+	}
+
+	bool KeyValueDb::SyncOnWrite() {
+		if (sync_write_) {
+			return true;
+		}
+		utils::MutexGuard guard(mutex_);
+		unsynced_count_++;
+		return false;
+	}
+
+	bool KeyValueDb::SyncWal() {
+		int64_t count = unsynced_count();
+		if (count == 0) {
+			return true;
+		}
+
+		//an empty synced write syncs the wal of the writes before it
+		WRITE_BATCH batch;
+		if (!WriteSynced(batch)) {
+			return false;
+		}
+		utils::MutexGuard guard(mutex_);
+		unsynced_count_ -= count;
+		return true;
+	}
+
+	int64_t KeyValueDb::unsynced_count() {
+		utils::MutexGuard guard(mutex_);
+		return unsynced_count_;
+	}
+
+	class BatchAppender : public WRITE_BATCH::Handler {
+	public:
+		BatchAppender(WRITE_BATCH &dest) : dest_(dest) {}
+
+		virtual void Put(const SLICE &key, const SLICE &value) {
+			dest_.Put(key, value);
+		}
+
+		virtual void Delete(const SLICE &key) {
+			dest_.Delete(key);
+		}
+	private:
+		WRITE_BATCH &dest_;
+	};
+
+	void KeyValueDb::AppendBatch(WRITE_BATCH &dest, const WRITE_BATCH &src) {
+		BatchAppender appender(dest);
+		src.Iterate(&appender);
+	}
+
+	KeyValueDbSnapshot::KeyValueDbSnapshot(KeyValueDb *db) : db_(db) {
+		snapshot_ = db_->NewSnapshot();
+	}
+
+	KeyValueDbSnapshot::~KeyValueDbSnapshot() {
+		db_->ReleaseSnapshot(snapshot_);
+	}
+
+	int32_t KeyValueDbSnapshot::Get(const std::string &key, std::string &value) {
+		return db_->Get(key, value, snapshot_);
+	}
+
 #ifdef WIN32
 	LevelDbDriver::LevelDbDriver() {
 		db_ = NULL;
@@ -60,14 +131,21 @@ namespace bumo {
 	}
 
 	int32_t LevelDbDriver::Get(const std::string &key, std::string &value) {
+		return Get(key, value, NULL);
+	}
+
+	int32_t LevelDbDriver::Get(const std::string &key, std::string &value, const void *snapshot) {
 		assert(db_ != NULL);
 
+		leveldb::ReadOptions options;
+		options.snapshot = (const leveldb::Snapshot *)snapshot;
+
 		//retry 10s
 		size_t timers = 0;
 		int32_t ret = -1;
 		while (timers < 10) {
 
-			leveldb::Status status = db_->Get(leveldb::ReadOptions(), key, &value);
+			leveldb::Status status = db_->Get(options, key, &value);
 			if (status.ok()) {
 				ret = 1;
 				break;
@@ -93,7 +171,7 @@ namespace bumo {
 	bool LevelDbDriver::Put(const std::string &key, const std::string &value) {
 		assert(db_ != NULL);
 		leveldb::WriteOptions opt;
-		opt.sync = true;
+		opt.sync = SyncOnWrite();
 		leveldb::Status status = db_->Put(opt, key, value);
 		if (!status.ok()) {
 			utils::MutexGuard guard(mutex_);
@@ -104,7 +182,9 @@ namespace bumo {
 
 	bool LevelDbDriver::Delete(const std::string &key) {
 		assert(db_ != NULL);
-		leveldb::Status status = db_->Delete(leveldb::WriteOptions(), key);
+		leveldb::WriteOptions opt;
+		opt.sync = SyncOnWrite();
+		leveldb::Status status = db_->Delete(opt, key);
 		if (!status.ok()) {
 			error_desc_ = status.ToString();
 		}
@@ -113,6 +193,17 @@ namespace bumo {
 
 	bool LevelDbDriver::WriteBatch(WRITE_BATCH &write_batch) {
 
+		leveldb::WriteOptions opt;
+		opt.sync = SyncOnWrite();
+		leveldb::Status status = db_->Write(opt, &write_batch);
+		if (!status.ok()) {
+			utils::MutexGuard guard(mutex_);
+			error_desc_ = status.ToString();
+		}
+		return status.ok();
+	}
+
+	bool LevelDbDriver::WriteSynced(WRITE_BATCH &write_batch) {
 		leveldb::WriteOptions opt;
 		opt.sync = true;
 		leveldb::Status status = db_->Write(opt, &write_batch);
@@ -127,47 +218,283 @@ namespace bumo {
 		return db_->NewIterator(leveldb::ReadOptions());
 	}
 
+	const void* LevelDbDriver::NewSnapshot() {
+		return db_->GetSnapshot();
+	}
+
+	void LevelDbDriver::ReleaseSnapshot(const void *snapshot) {
+		db_->ReleaseSnapshot((const leveldb::Snapshot *)snapshot);
+	}
+
 	bool LevelDbDriver::GetOptions(Json::Value &options) {
 		return true;
 	}
 
 #else
 
+	//iterates the keys of all the column families in one order, as if they were in one family
+	class ColumnFamiliesIterator : public rocksdb::Iterator {
+	public:
+		ColumnFamiliesIterator(const std::vector<rocksdb::Iterator *> &children) :
+			children_(children), current_(NULL), forward_(true) {}
+
+		virtual ~ColumnFamiliesIterator() {
+			for (size_t i = 0; i < children_.size(); i++) {
+				delete children_[i];
+			}
+		}
+
+		virtual bool Valid() const {
+			return current_ != NULL;
+		}
+
+		virtual void SeekToFirst() {
+			for (size_t i = 0; i < children_.size(); i++) {
+				children_[i]->SeekToFirst();
+			}
+			forward_ = true;
+			FindSmallest();
+		}
+
+		virtual void SeekToLast() {
+			for (size_t i = 0; i < children_.size(); i++) {
+				children_[i]->SeekToLast();
+			}
+			forward_ = false;
+			FindLargest();
+		}
+
+		virtual void Seek(const rocksdb::Slice &target) {
+			for (size_t i = 0; i < children_.size(); i++) {
+				children_[i]->Seek(target);
+			}
+			forward_ = true;
+			FindSmallest();
+		}
+
+		virtual void Next() {
+			if (!forward_) {
+				//the other children are before the key, move them after it
+				std::string key = current_->key().ToString();
+				for (size_t i = 0; i < children_.size(); i++) {
+					if (children_[i] == current_) continue;
+					children_[i]->Seek(key);
+					if (children_[i]->Valid() && children_[i]->key() == rocksdb::Slice(key)) {
+						children_[i]->Next();
+					}
+				}
+				forward_ = true;
+			}
+			current_->Next();
+			FindSmallest();
+		}
+
+		virtual void Prev() {
+			if (forward_) {
+				//the other children are after the key, move them before it
+				std::string key = current_->key().ToString();
+				for (size_t i = 0; i < children_.size(); i++) {
+					if (children_[i] == current_) continue;
+					children_[i]->Seek(key);
+					if (children_[i]->Valid()) {
+						children_[i]->Prev();
+					}
+					else {
+						children_[i]->SeekToLast();
+					}
+				}
+				forward_ = false;
+			}
+			current_->Prev();
+			FindLargest();
+		}
+
+		virtual rocksdb::Slice key() const {
+			return current_->key();
+		}
+
+		virtual rocksdb::Slice value() const {
+			return current_->value();
+		}
+
+		virtual rocksdb::Status status() const {
+			for (size_t i = 0; i < children_.size(); i++) {
+				if (!children_[i]->status().ok()) {
+					return children_[i]->status();
+				}
+			}
+			return rocksdb::Status::OK();
+		}
+	private:
+		void FindSmallest() {
+			current_ = NULL;
+			for (size_t i = 0; i < children_.size(); i++) {
+				if (children_[i]->Valid() && (current_ == NULL || children_[i]->key().compare(current_->key()) < 0)) {
+					current_ = children_[i];
+				}
+			}
+		}
+
+		void FindLargest() {
+			current_ = NULL;
+			for (size_t i = 0; i < children_.size(); i++) {
+				if (children_[i]->Valid() && (current_ == NULL || children_[i]->key().compare(current_->key()) > 0)) {
+					current_ = children_[i];
+				}
+			}
+		}
+
+		std::vector<rocksdb::Iterator *> children_;
+		rocksdb::Iterator *current_;
+		bool forward_;
+	};
+
+	//copy the puts and deletes of a batch into the column families of their keys
+	class ColumnFamilyRouter : public WRITE_BATCH::Handler {
+	public:
+		ColumnFamilyRouter(WRITE_BATCH &dest, std::function<rocksdb::ColumnFamilyHandle *(const SLICE &)> route) :
+			dest_(dest), route_(route) {}
+
+		virtual void Put(const SLICE &key, const SLICE &value) {
+			dest_.Put(route_(key), key, value);
+		}
+
+		virtual void Delete(const SLICE &key) {
+			dest_.Delete(route_(key), key);
+		}
+	private:
+		WRITE_BATCH &dest_;
+		std::function<rocksdb::ColumnFamilyHandle *(const SLICE &)> route_;
+	};
+
 	RocksDbDriver::RocksDbDriver() {
 		db_ = NULL;
 	}
 
+	RocksDbDriver::RocksDbDriver(const DbTuning &tuning, std::shared_ptr<rocksdb::Cache> block_cache, const ColumnFamilyPrefixes &column_families) :
+		tuning_(tuning),
+		block_cache_(block_cache),
+		column_families_(column_families) {
+		db_ = NULL;
+	}
+
 	RocksDbDriver::~RocksDbDriver() {
-		if (db_ != NULL) {
-			delete db_;
-			db_ = NULL;
+		Close();
+	}
+
+	bool RocksDbDriver::NewColumnFamilyOptions(rocksdb::ColumnFamilyOptions &options) {
+		if (tuning_.write_buffer_size_ > 0) {
+			options.write_buffer_size = (size_t)tuning_.write_buffer_size_;
+		}
+		if (tuning_.max_write_buffer_number_ > 0) {
+			options.max_write_buffer_number = tuning_.max_write_buffer_number_;
 		}
+
+		for (utils::StringList::const_iterator iter = tuning_.compression_per_level_.begin(); iter != tuning_.compression_per_level_.end(); iter++) {
+			const std::string &name = *iter;
+			if (name == "none") options.compression_per_level.push_back(rocksdb::kNoCompression);
+			else if (name == "snappy") options.compression_per_level.push_back(rocksdb::kSnappyCompression);
+			else if (name == "zlib") options.compression_per_level.push_back(rocksdb::kZlibCompression);
+			else if (name == "bzip2") options.compression_per_level.push_back(rocksdb::kBZip2Compression);
+			else if (name == "lz4") options.compression_per_level.push_back(rocksdb::kLZ4Compression);
+			else if (name == "lz4hc") options.compression_per_level.push_back(rocksdb::kLZ4HCCompression);
+			else {
+				utils::MutexGuard guard(mutex_);
+				error_desc_ = utils::String::Format("Unknown compression type(%s)", name.c_str());
+				return false;
+			}
+		}
+		if (options.compression_per_level.size() > 0) {
+			options.num_levels = MAX(options.num_levels, (int)options.compression_per_level.size());
+		}
+
+		rocksdb::BlockBasedTableOptions table_options;
+		if (block_cache_ != nullptr) {
+			table_options.block_cache = block_cache_;
+		}
+		if (tuning_.bloom_bits_per_key_ > 0) {
+			table_options.filter_policy.reset(rocksdb::NewBloomFilterPolicy(tuning_.bloom_bits_per_key_));
+		}
+		options.table_factory.reset(rocksdb::NewBlockBasedTableFactory(table_options));
+		return true;
+	}
+
+	rocksdb::ColumnFamilyHandle *RocksDbDriver::Route(const rocksdb::Slice &key) {
+		for (size_t i = 0; i < routes_.size(); i++) {
+			if (key.starts_with(routes_[i].first)) {
+				return routes_[i].second;
+			}
+		}
+		return db_->DefaultColumnFamily();
 	}
 
 	bool RocksDbDriver::Open(const std::string &db_path, int max_open_files) {
-		rocksdb::Options options;
+		rocksdb::DBOptions options;
 		if (max_open_files > 0)
 		{
 			options.max_open_files = max_open_files;
 		}
 		options.create_if_missing = true;
-		rocksdb::Status status = rocksdb::DB::Open(options, db_path, &db_);
+		options.create_missing_column_families = true;
+
+		//an existing db is opened with the column families it has, the layout is fixed when it is created
+		std::vector<std::string> names;
+		if (!rocksdb::DB::ListColumnFamilies(options, db_path, &names).ok()) {
+			names.clear();
+			names.push_back(rocksdb::kDefaultColumnFamilyName);
+			for (ColumnFamilyPrefixes::const_iterator iter = column_families_.begin(); iter != column_families_.end() && tuning_.column_families_; iter++) {
+				names.push_back(iter->first);
+			}
+		}
+
+		std::vector<rocksdb::ColumnFamilyDescriptor> descriptors;
+		for (size_t i = 0; i < names.size(); i++) {
+			rocksdb::ColumnFamilyOptions cf_options;
+			if (!NewColumnFamilyOptions(cf_options)) {
+				return false;
+			}
+			descriptors.push_back(rocksdb::ColumnFamilyDescriptor(names[i], cf_options));
+		}
+
+		rocksdb::Status status = rocksdb::DB::Open(options, db_path, descriptors, &handles_, &db_);
 		if (!status.ok()) {
 			utils::MutexGuard guard(mutex_);
 			error_desc_ = status.ToString();
+			return false;
 		}
-		return status.ok();
+
+		for (size_t i = 0; i < handles_.size(); i++) {
+			ColumnFamilyPrefixes::const_iterator iter = column_families_.find(handles_[i]->GetName());
+			if (iter == column_families_.end()) {
+				continue;
+			}
+			for (utils::StringList::const_iterator prefix = iter->second.begin(); prefix != iter->second.end(); prefix++) {
+				routes_.push_back(std::make_pair(*prefix, handles_[i]));
+			}
+		}
+		return true;
 	}
 
 	bool RocksDbDriver::Close() {
+		for (size_t i = 0; i < handles_.size(); i++) {
+			delete handles_[i];
+		}
+		handles_.clear();
+		routes_.clear();
 		delete db_;
 		db_ = NULL;
 		return true;
 	}
 
 	int32_t RocksDbDriver::Get(const std::string &key, std::string &value) {
+		return Get(key, value, NULL);
+	}
+
+	int32_t RocksDbDriver::Get(const std::string &key, std::string &value, const void *snapshot) {
 		assert(db_ != NULL);
-		rocksdb::Status status = db_->Get(rocksdb::ReadOptions(), key, &value);
+		rocksdb::ReadOptions options;
+		options.snapshot = (const rocksdb::Snapshot *)snapshot;
+		rocksdb::Status status = db_->Get(options, Route(key), key, &value);
 		if (status.ok()) {
 			return 1;
 		}
@@ -184,8 +511,8 @@ namespace bumo {
 	bool RocksDbDriver::Put(const std::string &key, const std::string &value) {
 		assert(db_ != NULL);
 		rocksdb::WriteOptions opt;
-		opt.sync = true;
-		rocksdb::Status status = db_->Put(opt, key, value);
+		opt.sync = SyncOnWrite();
+		rocksdb::Status status = db_->Put(opt, Route(key), key, value);
 		if (!status.ok()) {
 			utils::MutexGuard guard(mutex_);
 			error_desc_ = status.ToString();
@@ -196,8 +523,8 @@ namespace bumo {
 	bool RocksDbDriver::Delete(const std::string &key) {
 		assert(db_ != NULL);
 		rocksdb::WriteOptions opt;
-		opt.sync = true;
-		rocksdb::Status status = db_->Delete(opt, key);
+		opt.sync = SyncOnWrite();
+		rocksdb::Status status = db_->Delete(opt, Route(key), key);
 		if (!status.ok()) {
 			utils::MutexGuard guard(mutex_);
 			error_desc_ = status.ToString();
@@ -207,6 +534,26 @@ namespace bumo {
 
 	bool RocksDbDriver::WriteBatch(WRITE_BATCH &write_batch) {
 
+		rocksdb::WriteOptions opt;
+		opt.sync = SyncOnWrite();
+		rocksdb::Status status;
+		if (routes_.empty()) {
+			status = db_->Write(opt, &write_batch);
+		}
+		else {
+			WRITE_BATCH routed_batch;
+			ColumnFamilyRouter router(routed_batch, [this](const SLICE &key) { return Route(key); });
+			write_batch.Iterate(&router);
+			status = db_->Write(opt, &routed_batch);
+		}
+		if (!status.ok()) {
+			utils::MutexGuard guard(mutex_);
+			error_desc_ = status.ToString();
+		}
+		return status.ok();
+	}
+
+	bool RocksDbDriver::WriteSynced(WRITE_BATCH &write_batch) {
 		rocksdb::WriteOptions opt;
 		opt.sync = true;
 		rocksdb::Status status = db_->Write(opt, &write_batch);
@@ -218,7 +565,27 @@ namespace bumo {
 	}
 
 	void* RocksDbDriver::NewIterator() {
-		return db_->NewIterator(rocksdb::ReadOptions());
+		if (handles_.size() <= 1) {
+			return db_->NewIterator(rocksdb::ReadOptions());
+		}
+
+		//the keys are routed to the column families, iterate all of them
+		std::vector<rocksdb::Iterator *> iterators;
+		rocksdb::Status status = db_->NewIterators(rocksdb::ReadOptions(), handles_, &iterators);
+		if (!status.ok()) {
+			utils::MutexGuard guard(mutex_);
+			error_desc_ = status.ToString();
+			return rocksdb::NewErrorIterator(status);
+		}
+		return new ColumnFamiliesIterator(iterators);
+	}
+
+	const void* RocksDbDriver::NewSnapshot() {
+		return db_->GetSnapshot();
+	}
+
+	void RocksDbDriver::ReleaseSnapshot(const void *snapshot) {
+		db_->ReleaseSnapshot((const rocksdb::Snapshot *)snapshot);
 	}
 
 	bool RocksDbDriver::GetOptions(Json::Value &options) {
@@ -231,6 +598,19 @@ namespace bumo {
 
 		db_->GetProperty("rocksdb.stats", &out);
 		options["rocksdb.stats"] = out;
+
+		for (size_t i = 0; i < handles_.size(); i++) {
+			if (handles_[i]->GetName() == rocksdb::kDefaultColumnFamilyName) {
+				continue;
+			}
+			db_->GetProperty(handles_[i], "rocksdb.stats", &out);
+			options["column_families"][handles_[i]->GetName()] = out;
+		}
+
+		if (block_cache_ != nullptr) {
+			options["block_cache_usage"] = (Json::UInt64)block_cache_->GetUsage();
+		}
+		options["unsynced_writes"] = (Json::Int64)unsynced_count();
 		return true;
 	}
 #endif
@@ -239,6 +619,9 @@ namespace bumo {
 		keyvalue_db_ = NULL;
 		ledger_db_ = NULL;
 		account_db_ = NULL;
+		single_db_ = false;
+		wal_sync_interval_ = 0;
+		last_wal_sync_time_ = 0;
 		check_interval_ = utils::MICRO_UNITS_PER_SEC;
 	}
 
@@ -269,7 +652,7 @@ namespace bumo {
 				do {
 					//check the db if opened only for linux or mac
 #ifndef WIN32
-					KeyValueDb *account_db = NewKeyValueDb(db_config);
+					KeyValueDb *account_db = NewKeyValueDb(db_config, db_config.account_tuning_, AccountColumnFamilies());
 					if (!account_db->Open(db_config.account_db_path_, -1)) {
 						LOG_ERROR("Drop failed, error desc(%s)", account_db->error_desc().c_str());
 						delete account_db;
@@ -334,27 +717,63 @@ namespace bumo {
 			LOG_INFO("mac os db file limited:%d, keyvaule:%d, ledger:%d, account:%d:",
 				max_open_files, keyvaule_max_open_files, ledger_max_open_files, account_max_open_files);
 #endif
-			keyvalue_db_ = NewKeyValueDb(db_config);
+#ifndef WIN32
+			if (db_config.block_cache_size_ > 0) {
+				block_cache_ = rocksdb::NewLRUCache((size_t)db_config.block_cache_size_);
+			}
+#endif
+			keyvalue_db_ = NewKeyValueDb(db_config, db_config.keyvalue_tuning_, ColumnFamilyPrefixes());
 			if (!keyvalue_db_->Open(db_config.keyvalue_db_path_, keyvaule_max_open_files)) {
 				LOG_ERROR("Keyvalue_db path(%s) open fail(%s)\n",
 					db_config.keyvalue_db_path_.c_str(), keyvalue_db_->error_desc().c_str());
 				break;
 			}
+			//consensus status and peer list, synced in batches when async_write_kv is set
+			keyvalue_db_->SetSyncWrite(!db_config.async_write_kv_);
+			wal_sync_interval_ = db_config.wal_sync_interval_ * utils::MICRO_UNITS_PER_MILLI;
 
-			ledger_db_ = NewKeyValueDb(db_config);
-			if (!ledger_db_->Open(db_config.ledger_db_path_, ledger_max_open_files)) {
-				LOG_ERROR("Ledger db path(%s) open fail(%s)\n",
-					db_config.ledger_db_path_.c_str(), ledger_db_->error_desc().c_str());
-				break;
+			//the layout of the existing dbs wins over the configure
+			single_db_ = false;
+#ifndef WIN32
+			std::vector<std::string> existing_families;
+			rocksdb::DB::ListColumnFamilies(rocksdb::DBOptions(), db_config.account_db_path_, &existing_families);
+			if (std::find(existing_families.begin(), existing_families.end(), "ledger") != existing_families.end()) {
+				single_db_ = true;
+			}
+			else if (db_config.single_db_ && !utils::File::IsExist(db_config.ledger_db_path_)) {
+				single_db_ = true;
+			}
+			else if (db_config.single_db_) {
+				LOG_WARN("Ledger db path(%s) exists, keep the ledger out of the account db", db_config.ledger_db_path_.c_str());
+			}
+#endif
+
+			ColumnFamilyPrefixes account_column_families = AccountColumnFamilies();
+			if (single_db_) {
+				ColumnFamilyPrefixes ledger_families = LedgerColumnFamilies();
+				account_column_families.insert(ledger_families.begin(), ledger_families.end());
+			}
+			else {
+				ledger_db_ = NewKeyValueDb(db_config, db_config.ledger_tuning_, LedgerColumnFamilies());
+				if (!ledger_db_->Open(db_config.ledger_db_path_, ledger_max_open_files)) {
+					LOG_ERROR("Ledger db path(%s) open fail(%s)\n",
+						db_config.ledger_db_path_.c_str(), ledger_db_->error_desc().c_str());
+					break;
+				}
 			}
 
-			account_db_ = NewKeyValueDb(db_config);
+			account_db_ = NewKeyValueDb(db_config, db_config.account_tuning_, account_column_families);
 			if (!account_db_->Open(db_config.account_db_path_, account_max_open_files)) {
 				LOG_ERROR("Ledger db path(%s) open fail(%s)\n",
 					db_config.account_db_path_.c_str(), account_db_->error_desc().c_str());
 				break;
 			}
 
+			if (single_db_) {
+				ledger_db_ = account_db_;
+				LOG_INFO("The ledger is stored in the account db(%s)", db_config.account_db_path_.c_str());
+			}
+
 			TimerNotify::RegisterModule(this);
 			return true;
 
@@ -368,16 +787,17 @@ namespace bumo {
 	bool  Storage::CloseDb() {
 		bool ret1 = true, ret2 = true, ret3 = true;
 		if (keyvalue_db_ != NULL) {
+			keyvalue_db_->SyncWal();
 			ret1 = keyvalue_db_->Close();
 			delete keyvalue_db_;
 			keyvalue_db_ = NULL;
 		}
 
-		if (ledger_db_ != NULL) {
+		if (ledger_db_ != NULL && ledger_db_ != account_db_) {
 			ret2 = ledger_db_->Close();
 			delete ledger_db_;
-			ledger_db_ = NULL;
 		}
+		ledger_db_ = NULL;
 
 		if (account_db_ != NULL) {
 			ret3 = account_db_->Close();
@@ -393,6 +813,14 @@ namespace bumo {
 	}
 
 	void Storage::OnSlowTimer(int64_t current_time) {
+		if (keyvalue_db_ == NULL || current_time - last_wal_sync_time_ < wal_sync_interval_) {
+			return;
+		}
+
+		last_wal_sync_time_ = current_time;
+		if (!keyvalue_db_->SyncWal()) {
+			LOG_ERROR("Sync keyvalue db wal failed, error desc(%s)", keyvalue_db_->error_desc().c_str());
+		}
 	}
 
 	KeyValueDb *Storage::keyvalue_db() {
@@ -403,18 +831,42 @@ namespace bumo {
 		return ledger_db_;
 	}
 
+	bool Storage::IsSingleDb() {
+		return single_db_;
+	}
+
 	KeyValueDb *Storage::account_db() {
 		return account_db_;
 	}
 
-	KeyValueDb *Storage::NewKeyValueDb(const DbConfigure &db_config) {
+	KeyValueDb *Storage::NewKeyValueDb(const DbConfigure &db_config, const DbTuning &tuning, const ColumnFamilyPrefixes &column_families) {
 		KeyValueDb *db = NULL;
 #ifdef WIN32
 		db = new LevelDbDriver();
 #else
-		db = new RocksDbDriver();
+		db = new RocksDbDriver(tuning, block_cache_, column_families);
 #endif
 
 		return db;
 	}
+
+	ColumnFamilyPrefixes Storage::AccountColumnFamilies() {
+		ColumnFamilyPrefixes column_families;
+		utils::StringList &trie = column_families["trie"];
+		trie.push_back(General::ACCOUNT_PREFIX);
+		trie.push_back(ComposePrefix(General::ASSET_PREFIX, ""));
+		trie.push_back(ComposePrefix(General::METADATA_PREFIX, ""));
+		return column_families;
+	}
+
+	ColumnFamilyPrefixes Storage::LedgerColumnFamilies() {
+		ColumnFamilyPrefixes column_families;
+		utils::StringList &transaction = column_families["transaction"];
+		transaction.push_back(ComposePrefix(General::TRANSACTION_PREFIX, ""));
+		transaction.push_back(ComposePrefix(General::LEDGER_TRANSACTION_PREFIX, ""));
+		utils::StringList &ledger = column_families["ledger"];
+		ledger.push_back(ComposePrefix(General::LEDGER_PREFIX, ""));
+		ledger.push_back(ComposePrefix(General::CONSENSUS_VALUE_PREFIX, ""));
+		return column_families;
+	}
 }
\ No newline at end of file
@@ -26,6 +26,7 @@
 #include <leveldb/leveldb.h>
 #else
 #include <rocksdb/db.h>
+#include <rocksdb/cache.h>
 #endif
 
 namespace bumo {
@@ -43,16 +44,27 @@ namespace bumo {
 #define SLICE       rocksdb::Slice
 #endif
 
+	//column family name -> prefixes of the keys stored in it
+	typedef std::map<std::string, utils::StringList> ColumnFamilyPrefixes;
+
 	class KeyValueDb {
 	protected:
 		utils::Mutex mutex_;
 		std::string error_desc_;
+		bool sync_write_;
+		int64_t unsynced_count_;
+
+		//whether this write syncs the wal, an unsynced write is left to SyncWal
+		bool SyncOnWrite();
+		virtual bool WriteSynced(WRITE_BATCH &values) = 0;
 	public:
 		KeyValueDb();
 		~KeyValueDb();
 		virtual bool Open(const std::string &db_path, int max_open_files) = 0;
 		virtual bool Close() = 0;
 		virtual int32_t Get(const std::string &key, std::string &value) = 0;
+		//read from a snapshot of NewSnapshot
+		virtual int32_t Get(const std::string &key, std::string &value, const void *snapshot) = 0;
 		virtual bool Put(const std::string &key, const std::string &value) = 0;
 		virtual bool Delete(const std::string &key) = 0;
 		virtual bool GetOptions(Json::Value &options) = 0;
@@ -62,6 +74,18 @@ namespace bumo {
 		virtual bool WriteBatch(WRITE_BATCH &values) = 0;
 
 		virtual void* NewIterator() = 0;
+
+		virtual const void* NewSnapshot() = 0;
+		virtual void ReleaseSnapshot(const void *snapshot) = 0;
+
+		//append the puts and deletes of src to the end of dest
+		static void AppendBatch(WRITE_BATCH &dest, const WRITE_BATCH &src);
+
+		//false : the writes stay in the os cache until SyncWal, only for the data can be rebuilt
+		void SetSyncWrite(bool sync_write);
+		//sync the wal with all the unsynced writes before
+		bool SyncWal();
+		int64_t unsynced_count();
 	};
 
 #ifdef WIN32
@@ -69,6 +93,7 @@ namespace bumo {
 	private:
 		leveldb::DB* db_;
 
+		bool WriteSynced(WRITE_BATCH &values);
 	public:
 		LevelDbDriver();
 		~LevelDbDriver();
@@ -76,34 +101,66 @@ namespace bumo {
 		bool Open(const std::string &db_path, int max_open_files);
 		bool Close();
 		int32_t Get(const std::string &key, std::string &value);
+		int32_t Get(const std::string &key, std::string &value, const void *snapshot);
 		bool Put(const std::string &key, const std::string &value);
 		bool Delete(const std::string &key);
 		bool GetOptions(Json::Value &options);
 		bool WriteBatch(WRITE_BATCH &values);
 
 		void* NewIterator();
+
+		const void* NewSnapshot();
+		void ReleaseSnapshot(const void *snapshot);
 	};
 #else
 	class RocksDbDriver : public KeyValueDb {
 	private:
 		rocksdb::DB* db_;
+		DbTuning tuning_;
+		std::shared_ptr<rocksdb::Cache> block_cache_;
+		ColumnFamilyPrefixes column_families_;
+
+		std::vector<rocksdb::ColumnFamilyHandle *> handles_;
+		std::vector<std::pair<std::string, rocksdb::ColumnFamilyHandle *>> routes_; //key prefix -> column family
 
+		bool NewColumnFamilyOptions(rocksdb::ColumnFamilyOptions &options);
+		rocksdb::ColumnFamilyHandle *Route(const rocksdb::Slice &key);
+		bool WriteSynced(WRITE_BATCH &values);
 	public:
 		RocksDbDriver();
+		RocksDbDriver(const DbTuning &tuning, std::shared_ptr<rocksdb::Cache> block_cache, const ColumnFamilyPrefixes &column_families);
 		~RocksDbDriver();
 
 		bool Open(const std::string &db_path, int max_open_files);
 		bool Close();
 		int32_t Get(const std::string &key, std::string &value);
+		int32_t Get(const std::string &key, std::string &value, const void *snapshot);
 		bool Put(const std::string &key, const std::string &value);
 		bool Delete(const std::string &key);
 		bool GetOptions(Json::Value &options);
 		bool WriteBatch(WRITE_BATCH &values);
 
 		void* NewIterator();
+
+		const void* NewSnapshot();
+		void ReleaseSnapshot(const void *snapshot);
 	};
 #endif
 
+	//a consistent read-only view of a db, released with the last reference
+	class KeyValueDbSnapshot {
+	public:
+		typedef std::shared_ptr<KeyValueDbSnapshot> pointer;
+
+		KeyValueDbSnapshot(KeyValueDb *db);
+		~KeyValueDbSnapshot();
+
+		int32_t Get(const std::string &key, std::string &value);
+	private:
+		KeyValueDb *db_;
+		const void *snapshot_;
+	};
+
 	class Storage : public utils::Singleton<bumo::Storage>, public TimerNotify {
 		friend class utils::Singleton<Storage>;
 	private:
@@ -113,13 +170,24 @@ namespace bumo {
 		KeyValueDb *keyvalue_db_;
 		KeyValueDb *ledger_db_;
 		KeyValueDb *account_db_;
+		bool single_db_;
+		int64_t wal_sync_interval_;
+		int64_t last_wal_sync_time_;
+#ifndef WIN32
+		std::shared_ptr<rocksdb::Cache> block_cache_;
+#endif
 
 		bool CloseDb();
 		bool DescribeTable(const std::string &name, const std::string &sql_create_table);
 		bool ManualDescribeTables();
 
-		KeyValueDb *NewKeyValueDb(const DbConfigure &db_config);
+		KeyValueDb *NewKeyValueDb(const DbConfigure &db_config, const DbTuning &tuning, const ColumnFamilyPrefixes &column_families);
 	public:
+		//trie nodes and leaves of the account db
+		static ColumnFamilyPrefixes AccountColumnFamilies();
+		//transactions and ledger headers of the ledger db
+		static ColumnFamilyPrefixes LedgerColumnFamilies();
+
 		bool Initialize(const DbConfigure &db_config, bool bdropdb);
 		bool Exit();
 
@@ -127,6 +195,9 @@ namespace bumo {
 		KeyValueDb *account_db();   //storage account tree
 		KeyValueDb *ledger_db();    //storage transaction and ledger
 
+		//the ledger db is the account db, a ledger can be written with one batch
+		bool IsSingleDb();
+
 		virtual void OnTimer(int64_t current_time) {};
 		virtual void OnSlowTimer(int64_t current_time);
 	};
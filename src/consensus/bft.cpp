@@ -373,7 +373,7 @@ namespace bumo {
 		return CheckMessageItem(env, validators_);
 	}
 
-	bool Pbft::CheckMessageItem(const protocol::PbftEnv &env, const ValidatorMap &validators) {
+	bool Pbft::CheckMessageItem(const protocol::PbftEnv &env, const ValidatorMap &validators, bool check_signature) {
 		//this function should output the error log
 		const protocol::Pbft &pbft = env.pbft();
 		const protocol::Signature &sig = env.signature();
@@ -466,13 +466,33 @@ namespace bumo {
 		}
 
 		//check the signature
-		if (!PublicKey::Verify(pbft.SerializeAsString(), sig.sign_data(), sig.public_key())) {
+		if (check_signature && !PublicKey::Verify(pbft.SerializeAsString(), sig.sign_data(), sig.public_key())) {
 			LOG_ERROR("Check received message's signature failed, desc(%s)", PbftDesc::GetPbft(pbft).c_str());
 			return false;
 		}
 		return true;
 	}
 
+	bool Pbft::CheckSignatures(const std::vector<const protocol::PbftEnv *> &envs) {
+		std::vector<SignatureEntry> entries;
+		for (size_t i = 0; i < envs.size(); i++) {
+			const protocol::Signature &sig = envs[i]->signature();
+			entries.push_back(SignatureEntry(envs[i]->pbft().SerializeAsString(), sig.sign_data(), sig.public_key()));
+		}
+
+		std::vector<bool> valid;
+		if (PublicKey::VerifyGroup(entries, valid)) {
+			return true;
+		}
+
+		for (size_t i = 0; i < valid.size(); i++) {
+			if (!valid[i]) {
+				LOG_ERROR("Check received message's signature failed, desc(%s)", PbftDesc::GetPbft(envs[i]->pbft()).c_str());
+			}
+		}
+		return false;
+	}
+
 	bool Pbft::CheckViewChangeWithRawValue(const protocol::PbftViewChangeWithRawValue &view_change_raw, const ValidatorMap &validators) {
 
 		if (!view_change_raw.has_view_change_env()) {
@@ -501,13 +521,15 @@ namespace bumo {
 			value_digest = pre_prepare.value_digest();
 
 			std::set<int64_t> replica_ids;
-			//check the prepare message
+			std::vector<const protocol::PbftEnv *> prepare_envs;
+			//check the prepare message, the signatures are verified together below
 			for (int32_t m = 0; m < prepared_set.prepare_size(); m++) {
 				const protocol::PbftEnv &prepare_env = prepared_set.prepare(m);
-				if (!CheckMessageItem(prepare_env, validators)) {
+				if (!CheckMessageItem(prepare_env, validators, false)) {
 					LOG_ERROR("Check vc prepared set failed, desc(%s)", PbftDesc::GetViewChangeRawValue(view_change_raw).c_str());
 					return false;
 				}
+				prepare_envs.push_back(&prepare_env);
 
 				const protocol::PbftPrepare &prepare = prepare_env.pbft().prepare();
 
@@ -521,6 +543,11 @@ namespace bumo {
 				replica_ids.insert(prepare.replica_id());
 			}
 
+			if (!CheckSignatures(prepare_envs)) {
+				LOG_ERROR("Check vc prepared set failed, desc(%s)", PbftDesc::GetViewChangeRawValue(view_change_raw).c_str());
+				return false;
+			}
+
 			if (replica_ids.size() < GetQuorumSize(validators.size())) {
 				LOG_ERROR("The view-change-raw message's prepared message's replica number(" FMT_SIZE ") is less than quorom size(" FMT_SIZE")",
 					 replica_ids.size(), GetQuorumSize(validators.size()) + 1);
@@ -1765,10 +1792,11 @@ namespace bumo {
 			return false;
 		}
 
+		std::vector<const protocol::PbftEnv *> commit_envs;
 		for (int32_t i = 0; i < pbft_evidence.commits_size(); i++) {
 			const protocol::PbftEnv &env = pbft_evidence.commits(i);
 			const protocol::Pbft &pbft = env.pbft();
-			if (!CheckMessageItem(env, temp_vs)) {
+			if (!CheckMessageItem(env, temp_vs, false)) {
 				LOG_ERROR("Check proof message item failed, validators:(%s), hash(%s), proof(%s), total_size(" FMT_SIZE "), qsize(" FMT_SIZE "), counter(" FMT_I64 ")", 
 					Proto2Json(validators).toFastString().c_str(), utils::String::BinToHexString(previous_value_hash).c_str(), 
 					Proto2Json(pbft_evidence).toFastString().c_str(),
@@ -1798,6 +1826,13 @@ namespace bumo {
 			}
 
 			temp_vs.erase(address);
+			commit_envs.push_back(&env);
+		}
+
+		//verify the commit signatures together
+		if (!CheckSignatures(commit_envs)) {
+			LOG_ERROR("Check proof failed, commit signature not valid, hash(%s)", utils::String::BinToHexString(previous_value_hash).c_str());
+			return false;
 		}
 
 		if (total_size - temp_vs.size() >= qsize) {
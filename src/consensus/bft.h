@@ -73,7 +73,8 @@ namespace bumo {
 		bool TryExecuteValue();
 		static protocol::PbftMessageType GetMessageType(const protocol::PbftEnv &env);
 		bool CheckMessageItem(const protocol::PbftEnv &env);
-		static bool CheckMessageItem(const protocol::PbftEnv &env, const ValidatorMap &validators);
+		static bool CheckMessageItem(const protocol::PbftEnv &env, const ValidatorMap &validators, bool check_signature = true);
+		static bool CheckSignatures(const std::vector<const protocol::PbftEnv *> &envs);
 		bool TraceOutPbftCommit(const protocol::PbftEnv &env);
 		bool TraceOutPbftPrePrepare(const protocol::PbftEnv &env);
 		void TryDoTraceOut(const PbftInstanceIndex &index, const PbftInstance &instance);
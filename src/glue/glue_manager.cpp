@@ -99,7 +99,8 @@ namespace bumo {
 		}
 
 		protocol::LedgerHeader lcl = LedgerManager::Instance().GetLastClosedLedger();
-		protocol::TransactionEnvSet txset_raw = tx_pool_->TopTransaction(Configure::Instance().ledger_configure_.max_trans_per_ledger_);
+		std::vector<TransactionFrm::pointer> txs;
+		tx_pool_->TopTransaction(Configure::Instance().ledger_configure_.max_trans_per_ledger_, txs);
 
 		int64_t next_close_time = utils::Timestamp::Now().timestamp();
 		if (next_close_time < lcl.close_time() + Configure::Instance().ledger_configure_.close_interval_) {
@@ -127,7 +128,7 @@ namespace bumo {
 
 		protocol::ConsensusValue propose_value;
 		do {
-			*propose_value.mutable_txset() = txset_raw;
+			TransactionSetFrm::ToProto(txs, *propose_value.mutable_txset());
 			propose_value.set_close_time(next_close_time);
 			propose_value.set_ledger_seq(lcl.seq() + 1);
 			propose_value.set_previous_ledger_hash(lcl.hash());
@@ -151,33 +152,40 @@ namespace bumo {
 			LedgerManager::Instance().context_manager_.SyncPreProcess(propose_value, true, propose_result);
 
 			if (propose_result.block_timeout_) {
-				//remove the time out tx
+				//the execution did not return in time, remove the time out tx
 				//reduct to 1/2
-				protocol::TransactionEnvSet tmp_raw;
-				for (int32_t i = 0; i < txset_raw.txs_size() / 2; i ++) {
-					*tmp_raw.add_txs() = txset_raw.txs(i);
-				}
+				txs.resize(txs.size() / 2);
+				continue;
+			}
 
-				txset_raw = tmp_raw;
+			//the value changes, the result executed is kept for the final value
+			std::string executed_hash;
+			bool sealed = propose_result.sealed_count_ >= 0 && propose_result.sealed_count_ < (int32_t)txs.size();
+			if (sealed || propose_result.need_dropped_tx_.size()) {
+				executed_hash = HashWrapper::Crypto(propose_value.SerializeAsString());
+			}
 
-				continue;
+			//the txs not applied in the time budget are left in the queue
+			if (sealed) {
+				LOG_INFO("Seal the proposed txset at %d of " FMT_SIZE " tx(s)", propose_result.sealed_count_, txs.size());
+				txs.resize(propose_result.sealed_count_);
+				TransactionSetFrm::ToProto(txs, *propose_value.mutable_txset());
 			}
 
 			//need drop some tx
 			if (propose_result.need_dropped_tx_.size()) {
-				protocol::TransactionEnvSet *txs = propose_value.mutable_txset();
-				txs->clear_txs();
-
-				protocol::TransactionEnvSet tmp_raw;
-				for (int32_t i = 0; i < txset_raw.txs_size(); i++) {
+				std::vector<TransactionFrm::pointer> kept_txs, dropped_txs;
+				for (int32_t i = 0; i < (int32_t)txs.size(); i++) {
 					if (propose_result.need_dropped_tx_.find(i) != propose_result.need_dropped_tx_.end()) {
 						//remove from the cache
-						*tmp_raw.add_txs() = txset_raw.txs(i);
+						dropped_txs.push_back(txs[i]);
 					} else{
-						*txs->add_txs() = txset_raw.txs(i);
+						kept_txs.push_back(txs[i]);
 					}
 				}
-				tx_pool_->RemoveTxs(tmp_raw);
+				txs.swap(kept_txs);
+				TransactionSetFrm::ToProto(txs, *propose_value.mutable_txset());
+				tx_pool_->RemoveTxs(dropped_txs);
 			} 
 
 			if (propose_result.cons_validation_.error_tx_ids_size() > 0 ||
@@ -188,6 +196,10 @@ namespace bumo {
 			LOG_INFO("Check validation, validation(%d,%d) ",
 				propose_result.cons_validation_.expire_tx_ids_size(), propose_result.cons_validation_.error_tx_ids_size());
 
+			if (!executed_hash.empty() && !LedgerManager::Instance().context_manager_.ReuseProposed(executed_hash, propose_value)) {
+				LOG_WARN("The executed result of the proposed value is not found, it will be executed again");
+			}
+
 			break;
 		} while (true);
 
@@ -14,6 +14,7 @@ along with bumo.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "transaction_queue.h"
+#include "transaction_set.h"
 #include <ledger/ledger_manager.h>
 #include <algorithm>
 
@@ -22,46 +23,92 @@ namespace bumo {
 	int64_t const QUEUE_TRANSACTION_TIMEOUT = 60 * utils::MICRO_UNITS_PER_SEC;
 
 	TransactionQueue::TransactionQueue(uint32_t queue_limit, uint32_t account_txs_limit)
-		: queue_(PriorityCompare{ *this }),
+		: size_(0),
 		queue_limit_(queue_limit),
 		account_txs_limit_(account_txs_limit)
 	{
+		for (uint32_t i = 0; i < HASH_FILTER_SIZE; i++) {
+			hash_filter_[i] = 0;
+		}
 	}
 
 	TransactionQueue::~TransactionQueue(){}
 
-	
-	std::pair<bool, TransactionFrm::pointer> TransactionQueue::Remove(QueueByAddressAndNonce::iterator& account_it, QueueByNonce::iterator& tx_it, bool del_empty){
-		TransactionFrm::pointer ptr = nullptr;
-		ptr = *tx_it->second.first;
-		queue_.erase(tx_it->second.first);
-		time_queue_.erase(tx_it->second.second);
-		account_it->second.erase(tx_it);
-		queue_by_hash_.erase(ptr->GetContentHash());
-
-		if (del_empty && account_it->second.empty()){
-			account_nonce_.erase(account_it->first);
-			queue_by_address_and_nonce_.erase(account_it);
+	TransactionQueue::Shard &TransactionQueue::GetShard(const std::string& account_address) {
+		return shards_[std::hash<std::string>()(account_address) % SHARD_COUNT];
+	}
+
+	TransactionQueue::HashStripe &TransactionQueue::GetHashStripe(const std::string& hash) {
+		return hash_stripes_[hash.empty() ? 0 : (uint8_t)hash[0] % HASH_STRIPE_COUNT];
+	}
+
+	void TransactionQueue::FilterAdd(const std::string& hash, bool add) {
+		size_t slot = std::hash<std::string>()(hash) % HASH_FILTER_SIZE;
+		if (add) {
+			utils::AtomicInc(&hash_filter_[slot]);
+		}
+		else {
+			utils::AtomicDec(&hash_filter_[slot]);
 		}
-		return std::move(std::make_pair(true, ptr));
+	}
+
+	bool TransactionQueue::FilterMayContain(const std::string& hash) {
+		return hash_filter_[std::hash<std::string>()(hash) % HASH_FILTER_SIZE] > 0;
 	}
 	
+	void TransactionQueue::Unlink(Shard &shard, const std::string& account_address, AccountQueue &account) {
+		if (account.head_gas_price_ >= 0) {
+			shard.heads_.erase(AccountKey(account.head_gas_price_, account_address));
+			account.head_gas_price_ = -1;
+		}
+		if (account.tail_gas_price_ >= 0) {
+			shard.tails_.erase(AccountKey(account.tail_gas_price_, account_address));
+			account.tail_gas_price_ = -1;
+		}
+	}
+
+	void TransactionQueue::Link(Shard &shard, const std::string& account_address, AccountQueue &account) {
+		if (account.txs_.empty()) {
+			return;
+		}
+
+		auto head = account.txs_.find(account.nonce_ + 1);
+		if (head != account.txs_.end()) {
+			account.head_gas_price_ = head->second.first->GetGasPrice();
+			shard.heads_.insert(AccountKey(account.head_gas_price_, account_address));
+		}
+		account.tail_gas_price_ = account.txs_.rbegin()->second.first->GetGasPrice();
+		shard.tails_.insert(AccountKey(account.tail_gas_price_, account_address));
+	}
 
-	std::pair<bool, TransactionFrm::pointer> TransactionQueue::Remove(const std::string& account_address,const int64_t& nonce){
+	TransactionFrm::pointer TransactionQueue::Erase(Shard &shard, AccountQueue &account, QueueByNonce::iterator& tx_it){
+		TransactionFrm::pointer ptr = tx_it->second.first;
+		shard.time_queue_.erase(tx_it->second.second);
+		account.txs_.erase(tx_it);
+		do {
+			HashStripe &stripe = GetHashStripe(ptr->GetContentHash());
+			utils::MutexGuard guard(stripe.lock_);
+			stripe.queue_by_hash_.erase(ptr->GetContentHash());
+		} while (false);
+		FilterAdd(ptr->GetContentHash(), false);
+		utils::AtomicDec(&size_);
+		return ptr;
+	}
+
+	std::pair<bool, TransactionFrm::pointer> TransactionQueue::Remove(Shard &shard, const std::string& account_address,const int64_t& nonce){
 		TransactionFrm::pointer ptr = nullptr;
-		auto account_it =queue_by_address_and_nonce_.find(account_address);
-		if (account_it != queue_by_address_and_nonce_.end()){
-			auto tx_it = account_it->second.find(nonce);
-			if (tx_it != account_it->second.end()){
-				ptr = *tx_it->second.first;
-				queue_.erase(tx_it->second.first);
-				time_queue_.erase(tx_it->second.second);
-				account_it->second.erase(tx_it);
-				queue_by_hash_.erase(ptr->GetContentHash());
-
-				if (account_it->second.empty()){
-					queue_by_address_and_nonce_.erase(account_it);
-					account_nonce_.erase(account_address);
+		auto account_it = shard.accounts_.find(account_address);
+		if (account_it != shard.accounts_.end()){
+			AccountQueue &account = account_it->second;
+			auto tx_it = account.txs_.find(nonce);
+			if (tx_it != account.txs_.end()){
+				Unlink(shard, account_address, account);
+				ptr = Erase(shard, account, tx_it);
+				if (account.txs_.empty()) {
+					shard.accounts_.erase(account_it);
+				}
+				else {
+					Link(shard, account_address, account);
 				}
 				return std::move(std::make_pair(true, ptr));
 			}
@@ -69,43 +116,86 @@ namespace bumo {
 		return std::move(std::make_pair(false, ptr));
 	}
 	
-	void TransactionQueue::Insert(TransactionFrm::pointer const& tx){
+	void TransactionQueue::Insert(Shard &shard, AccountQueue &account, TransactionFrm::pointer const& tx){
 		// Insert into queue
-		auto inserted = queue_by_address_and_nonce_[tx->GetSourceAddress()].insert(std::make_pair(tx->GetNonce(), std::make_pair(PriorityQueue::iterator(), TimeQueue::iterator())));
-		PriorityQueue::iterator left = queue_.emplace(tx);
-		TimeQueue::iterator right = time_queue_.emplace(tx);
-		inserted.first->second.first = left;
-		inserted.first->second.second = right;
-		queue_by_hash_[tx->GetContentHash()]=tx;
+		TimeQueue::iterator time_it = shard.time_queue_.emplace(tx);
+		account.txs_[tx->GetNonce()] = std::make_pair(tx, time_it);
+		do {
+			HashStripe &stripe = GetHashStripe(tx->GetContentHash());
+			utils::MutexGuard guard(stripe.lock_);
+			stripe.queue_by_hash_[tx->GetContentHash()] = tx;
+		} while (false);
+		FilterAdd(tx->GetContentHash(), true);
+		utils::AtomicInc(&size_);
+	}
+
+	TransactionFrm::pointer TransactionQueue::EvictLowest() {
+		while (true) {
+			//the last transaction of the account with the lowest one of all shards
+			Shard *lowest_shard = NULL;
+			AccountKey lowest;
+			for (uint32_t i = 0; i < SHARD_COUNT; i++) {
+				Shard &shard = shards_[i];
+				utils::ReadLockGuard g(shard.lock_);
+				if (shard.tails_.empty()) {
+					continue;
+				}
+
+				const AccountKey &key = *shard.tails_.begin();
+				if (lowest_shard == NULL || key < lowest) {
+					lowest_shard = &shard;
+					lowest = key;
+				}
+			}
+
+			if (lowest_shard == NULL) {
+				return nullptr;
+			}
+
+			utils::WriteLockGuard g(lowest_shard->lock_);
+			//the shard may have changed between the read and the write lock, then scan again
+			if (lowest_shard->tails_.empty() || *lowest_shard->tails_.begin() != lowest) {
+				continue;
+			}
+
+			auto account_it = lowest_shard->accounts_.find(lowest.second);
+			if (account_it == lowest_shard->accounts_.end() || account_it->second.txs_.empty() ||
+				account_it->second.txs_.rbegin()->second.first->GetGasPrice() != lowest.first) {
+				continue;
+			}
+			return Remove(*lowest_shard, lowest.second, account_it->second.txs_.rbegin()->first).second;
+		}
 	}
 
 	bool TransactionQueue::Import(TransactionFrm::pointer tx, const int64_t& cur_source_nonce,Result &result){
-		utils::WriteLockGuard g(lock_);
+		Shard &shard = GetShard(tx->GetSourceAddress());
 		bool inserted = false;
 		bool replace = false;
 		uint32_t account_txs_size = 0;
 
-		account_nonce_[tx->GetSourceAddress()] = cur_source_nonce;
-
-		LOG_TRACE("Import account(%s) transaction(%s) nonce(" FMT_I64 ") gas_price(" FMT_I64 ")", tx->GetSourceAddress().c_str(), utils::String::BinToHexString(tx->GetContentHash()).c_str(), tx->GetNonce(), tx->GetGasPrice());
-		auto account_it = queue_by_address_and_nonce_.find(tx->GetSourceAddress());
-		if (account_it != queue_by_address_and_nonce_.end()) {
+		do {
+			utils::WriteLockGuard g(shard.lock_);
+			AccountQueue &account = shard.accounts_[tx->GetSourceAddress()];
+			Unlink(shard, tx->GetSourceAddress(), account);
+			account.nonce_ = cur_source_nonce;
 
-			account_txs_size = account_it->second.size();
+			LOG_TRACE("Import account(%s) transaction(%s) nonce(" FMT_I64 ") gas_price(" FMT_I64 ")", tx->GetSourceAddress().c_str(), utils::String::BinToHexString(tx->GetContentHash()).c_str(), tx->GetNonce(), tx->GetGasPrice());
+			account_txs_size = account.txs_.size();
 
-			auto tx_it = account_it->second.find(tx->GetNonce());
-			if (tx_it != account_it->second.end()){
+			auto tx_it = account.txs_.find(tx->GetNonce());
+			if (tx_it != account.txs_.end()){
 
-				if (tx->GetGasPrice() > (*tx_it->second.first)->GetGasPrice()) {
+				if (tx->GetGasPrice() > tx_it->second.first->GetGasPrice()) {
 					//remove transaction for replace ,and after insert
-					std::string drop_hash = (*tx_it->second.first)->GetContentHash();
-					Remove(account_it, tx_it);
+					std::string drop_hash = tx_it->second.first->GetContentHash();
+					Erase(shard, account, tx_it);
 					replace = true;
 					account_txs_size--;
 					LOG_TRACE("Remove transaction(%s) for replace by transaction(%s) of account(%s) gas_price(" FMT_I64 ") nonce(" FMT_I64 ") in queue", utils::String::BinToHexString(drop_hash).c_str(), utils::String::BinToHexString(tx->GetContentHash()).c_str(), tx->GetSourceAddress().c_str(), tx->GetGasPrice(), tx->GetNonce());
 				}
 				else{
 					//Discard new transaction
+					Link(shard, tx->GetSourceAddress(), account);
 					std::string error_desc = utils::String::Format("Discard transaction(%s) of account(%s) gas_price(" FMT_I64 ") nonce(" FMT_I64 ") because of lower fee  in queue", utils::String::BinToHexString(tx->GetContentHash()).c_str(), tx->GetSourceAddress().c_str(), tx->GetGasPrice(), tx->GetNonce());
 					LOG_ERROR("%s", error_desc.c_str());
 					result.set_code(protocol::ERRCODE_TX_INSERT_QUEUE_FAIL);
@@ -113,15 +203,28 @@ namespace bumo {
 					return inserted;
 				}
 			}
-		}
 
-		if (replace || account_txs_size < account_txs_limit_) {
-			Insert(tx);	
-			inserted = true;
-			//todo...
-			while (queue_.size() > queue_limit_) {
-				TransactionFrm::pointer t = *queue_.rbegin();
-				Remove(t->GetSourceAddress(), t->GetNonce());
+			if (replace || account_txs_size < account_txs_limit_) {
+				Insert(shard, account, tx);
+				inserted = true;
+			}
+
+			if (account.txs_.empty()) {
+				shard.accounts_.erase(tx->GetSourceAddress());
+			}
+			else {
+				Link(shard, tx->GetSourceAddress(), account);
+			}
+		} while (false);
+
+		//the shard lock is released, the lowest may be in any shard
+		if (inserted && size_ > queue_limit_) {
+			utils::MutexGuard guard(evict_lock_);
+			while (size_ > queue_limit_) {
+				TransactionFrm::pointer t = EvictLowest();
+				if (t == nullptr) {
+					break;
+				}
 
 				std::string error_desc = utils::String::Format("Discard lowest transaction(%s) of account(%s) gas_price(" FMT_I64 ") nonce(" FMT_I64 ")  in queue", utils::String::BinToHexString(t->GetContentHash()).c_str(), t->GetSourceAddress().c_str(), t->GetGasPrice(), t->GetNonce());
 				LOG_TRACE("%s", error_desc.c_str());
@@ -145,138 +248,200 @@ namespace bumo {
 		return inserted;
 	}
 
-	protocol::TransactionEnvSet TransactionQueue::TopTransaction(uint32_t limit){
-		protocol::TransactionEnvSet set;
-		std::unordered_map<std::string, int64_t> topic_seqs;
-		std::unordered_map<std::string, int64_t> break_nonce_accounts;
-		int64_t last_block_seq = LedgerManager::Instance().GetLastClosedLedger().seq();
-		utils::WriteLockGuard g(lock_);
-		uint32_t i = 0;
-		
-		for (auto t = queue_.begin(); set.txs().size() < limit && t != queue_.end(); ++t) {
-			const TransactionFrm::pointer& tx = *t;
-			if (set.ByteSize() + tx->GetTransactionEnv().ByteSize() >= General::TXSET_LIMIT_SIZE)
-				break;
-			
-			if (break_nonce_accounts.find(tx->GetSourceAddress()) == break_nonce_accounts.end()) {
-
-				int64_t last_seq = 0;
-				do {
-					//find this cache
-					auto this_iter = topic_seqs.find(tx->GetSourceAddress());
-					if (this_iter != topic_seqs.end()) {
-						last_seq = this_iter->second;
-						break;
-					}
-
-					last_seq = account_nonce_[tx->GetSourceAddress()];
-
-				} while (false);
-
-				if (tx->GetNonce() > last_seq + 1) {
-					break_nonce_accounts[tx->GetSourceAddress()] = last_seq + 1;
-					continue;
+	void TransactionQueue::SelectExecutable(uint32_t limit, std::vector<TransactionFrm::pointer>& txs) {
+		//the heap holds the best head not taken of each shard, and the successor of each account taken
+		struct Candidate {
+			int64_t gas_price_;
+			const std::string *address_;
+			uint32_t shard_;
+			bool from_head_;
+			HeadSet::const_iterator head_;
+			QueueByNonce::const_iterator tx_;
+			QueueByNonce::const_iterator end_;
+		};
+		auto lower = [](const Candidate &first, const Candidate &second) {
+			if (first.gas_price_ != second.gas_price_) {
+				return first.gas_price_ < second.gas_price_;
+			}
+			if (*first.address_ != *second.address_) {
+				return *first.address_ > *second.address_;
+			}
+			return first.tx_->first > second.tx_->first;
+		};
+		auto head_candidate = [this](uint32_t shard_index, HeadSet::const_iterator head) {
+			const AccountQueue &account = shards_[shard_index].accounts_.find(head->second)->second;
+			Candidate candidate;
+			candidate.gas_price_ = head->first;
+			candidate.address_ = &head->second;
+			candidate.shard_ = shard_index;
+			candidate.from_head_ = true;
+			candidate.head_ = head;
+			candidate.tx_ = account.txs_.find(account.nonce_ + 1);
+			candidate.end_ = account.txs_.end();
+			return candidate;
+		};
+
+		std::vector<Candidate> heap;
+		for (uint32_t i = 0; i < SHARD_COUNT; i++) {
+			if (!shards_[i].heads_.empty()) {
+				heap.push_back(head_candidate(i, shards_[i].heads_.begin()));
+			}
+		}
+		std::make_heap(heap.begin(), heap.end(), lower);
+
+		while (!heap.empty() && txs.size() < limit) {
+			std::pop_heap(heap.begin(), heap.end(), lower);
+			Candidate best = heap.back();
+			heap.pop_back();
+			txs.push_back(best.tx_->second.first);
+
+			if (best.from_head_) {
+				HeadSet::const_iterator next_head = best.head_;
+				if (++next_head != shards_[best.shard_].heads_.end()) {
+					heap.push_back(head_candidate(best.shard_, next_head));
+					std::push_heap(heap.begin(), heap.end(), lower);
 				}
+			}
 
-				topic_seqs[tx->GetSourceAddress()] = tx->GetNonce();
+			QueueByNonce::const_iterator next = best.tx_;
+			if (++next != best.end_ && next->first == best.tx_->first + 1) {
+				Candidate successor = best;
+				successor.from_head_ = false;
+				successor.gas_price_ = next->second.first->GetGasPrice();
+				successor.tx_ = next;
+				heap.push_back(successor);
+				std::push_heap(heap.begin(), heap.end(), lower);
+			}
+		}
+	}
 
-				*set.add_txs() = tx->GetProtoTxEnv();
+	void TransactionQueue::TopTransaction(uint32_t limit, std::vector<TransactionFrm::pointer>& txs){
+		int64_t last_block_seq = LedgerManager::Instance().GetLastClosedLedger().seq();
+		//the selection only walks the taken transactions, the shards are locked for a short time
+		for (uint32_t i = 0; i < SHARD_COUNT; i++) {
+			shards_[i].lock_.ReadLock();
+		}
+		SelectExecutable(limit, txs);
+		for (uint32_t i = 0; i < SHARD_COUNT; i++) {
+			shards_[i].lock_.ReadUnlock();
+		}
 
-				i++;
-				//LOG_TRACE("top(%u) addr(%s) tx(%s) nonce(" FMT_I64 ") gas_price(" FMT_I64 ") last block seq(" FMT_I64 ")", i, tx->GetSourceAddress().c_str(), utils::String::BinToHexString(tx->GetContentHash()).c_str(), tx->GetNonce(), tx->GetGasPrice(), last_block_seq);
-			}
+		//the size of the set is summed up, it is not serialized here
+		int64_t byte_size = 0;
+		size_t i = 0;
+		for (; i < txs.size(); i++) {
+			int64_t entry_size = TransactionSetFrm::EntrySize(txs[i]);
+			if (byte_size + entry_size >= General::TXSET_LIMIT_SIZE)
+				break;
+			byte_size += entry_size;
 		}
-		LOG_TRACE("Take top size(%u) , last block seq(" FMT_I64 ") limit(%u) , txset byte size(%d)byte (%d)M", i, last_block_seq, limit, set.ByteSize() ,set.ByteSize() / utils::BYTES_PER_MEGA);
-		return std::move(set);
+		txs.resize(i);
+		LOG_TRACE("Take top size(" FMT_SIZE ") , last block seq(" FMT_I64 ") limit(%u) , txset byte size(" FMT_I64 ")byte (" FMT_I64 ")M", i, last_block_seq, limit, byte_size, byte_size / utils::BYTES_PER_MEGA);
 	}
 
 	uint32_t TransactionQueue::RemoveTxs(const protocol::TransactionEnvSet& set, bool close_ledger){
 		
 		uint32_t ret = 0;
 		int64_t last_seq = LedgerManager::Instance().GetLastClosedLedger().seq();
-		utils::WriteLockGuard g(lock_);
 		for (int i = 0; i < set.txs_size(); i++) {
 			auto txproto = set.txs(i);
 			std::string source_address = txproto.transaction().source_address();
 			int64_t nonce = txproto.transaction().nonce();
-			std::pair<bool, TransactionFrm::pointer> result = Remove(source_address, nonce);
+			Shard &shard = GetShard(source_address);
+			utils::WriteLockGuard g(shard.lock_);
+			std::pair<bool, TransactionFrm::pointer> result = Remove(shard, source_address, nonce);
 			if (result.first)
 				++ret;
 			
 			//LOG_TRACE("RemoveTxs close_ledger_flag(%d) (%d) removed(%d) addr(%s) nonce(" FMT_I64 ") fee(" FMT_I64 ") last seq(" FMT_I64 ")",
 			//	(int)close_ledger, i, (int)result.first, source_address.c_str(), nonce, (int64_t)txproto.transaction().fee(), last_seq);
 
-			//update system account nonce
-			auto it = account_nonce_.find(source_address);
-			if (close_ledger && it != account_nonce_.end() && it->second < nonce)
-				it->second = nonce;
+			//update system account nonce, the next nonce may be the head now
+			auto it = shard.accounts_.find(source_address);
+			if (close_ledger && it != shard.accounts_.end() && it->second.nonce_ < nonce) {
+				Unlink(shard, source_address, it->second);
+				it->second.nonce_ = nonce;
+				Link(shard, source_address, it->second);
+			}
 		}
 
-		LOG_TRACE("RemoveTxs close_ledger_flag(%d) set txs size(%d) real remove(%u) after queue size(%u) last block seq(" FMT_I64 ")", 
-			(int)close_ledger, set.txs_size(), ret, queue_.size(), last_seq);
+		LOG_TRACE("RemoveTxs close_ledger_flag(%d) set txs size(%d) real remove(%u) after queue size(" FMT_I64 ") last block seq(" FMT_I64 ")", 
+			(int)close_ledger, set.txs_size(), ret, (int64_t)size_, last_seq);
 		return ret;
 	}
 
 	void TransactionQueue::RemoveTxs(std::vector<TransactionFrm::pointer>& txs, bool close_ledger){
-		utils::WriteLockGuard g(lock_);
 		uint32_t i = 0;
 		int64_t last_seq = LedgerManager::Instance().GetLastClosedLedger().seq();
 		for (auto it = txs.begin(); it != txs.end(); it++){
 			std::string source_address = (*it)->GetSourceAddress();
 			int64_t nonce = (*it)->GetNonce();
+			Shard &shard = GetShard(source_address);
+			utils::WriteLockGuard g(shard.lock_);
 
-			auto result = Remove(source_address, nonce);
+			auto result = Remove(shard, source_address, nonce);
 			i++;
 			LOG_TRACE("RemoveTxs close_ledger_flag(%d) (%u) removed(%d) addr(%s) tx(%s), nonce(" FMT_I64 ") gas_price(" FMT_I64 ") last seq(" FMT_I64 ")", 
 				(int)close_ledger, i, (int)result.first, (*it)->GetSourceAddress().c_str(),
 				utils::String::BinToHexString((*it)->GetContentHash()).c_str(), (*it)->GetNonce(), (*it)->GetGasPrice(), last_seq);
 
-			//update system account nonce
-			auto iter = account_nonce_.find(source_address);
-			if (close_ledger && iter != account_nonce_.end() && iter->second < nonce)
-				iter->second = nonce;
+			//update system account nonce, the next nonce may be the head now
+			auto iter = shard.accounts_.find(source_address);
+			if (close_ledger && iter != shard.accounts_.end() && iter->second.nonce_ < nonce) {
+				Unlink(shard, source_address, iter->second);
+				iter->second.nonce_ = nonce;
+				Link(shard, source_address, iter->second);
+			}
 		}
-		LOG_TRACE("RemoveTxs after queue size(%u)", queue_.size());
+		LOG_TRACE("RemoveTxs after queue size(" FMT_I64 ")", (int64_t)size_);
 	}
 
 	void TransactionQueue::SafeRemoveTx(const std::string& account_address, const int64_t& nonce) {
-		utils::WriteLockGuard g(lock_);
-		std::pair<bool, TransactionFrm::pointer> result = Remove(account_address, nonce);
+		Shard &shard = GetShard(account_address);
+		utils::WriteLockGuard g(shard.lock_);
+		std::pair<bool, TransactionFrm::pointer> result = Remove(shard, account_address, nonce);
 	}
 
 
 
 	void TransactionQueue::CheckTimeout(int64_t current_time, std::vector<TransactionFrm::pointer>& timeout_txs){
-		utils::ReadLockGuard g(lock_);
-		for (auto it = time_queue_.begin(); it != time_queue_.end();it++){
-			if (!(*it)->CheckTimeout(current_time - QUEUE_TRANSACTION_TIMEOUT))
-				break;
-			timeout_txs.emplace_back(*it);
+		for (uint32_t i = 0; i < SHARD_COUNT; i++) {
+			Shard &shard = shards_[i];
+			utils::ReadLockGuard g(shard.lock_);
+			for (auto it = shard.time_queue_.begin(); it != shard.time_queue_.end(); it++){
+				if (!(*it)->CheckTimeout(current_time - QUEUE_TRANSACTION_TIMEOUT))
+					break;
+				timeout_txs.emplace_back(*it);
+			}
 		}
 	}
 
 	void TransactionQueue::CheckTimeoutAndDel(int64_t current_time,std::vector<TransactionFrm::pointer>& timeout_txs){
-		utils::WriteLockGuard g(lock_);
 		int64_t last_seq = LedgerManager::Instance().GetLastClosedLedger().seq();		
-		while (!time_queue_.empty()){
-			auto it =time_queue_.begin();
-			if (!(*it)->CheckTimeout(current_time - QUEUE_TRANSACTION_TIMEOUT))
-				break;
-			timeout_txs.emplace_back(*it);
-			std::string account_address = (*it)->GetSourceAddress();
-			int64_t nonce = (*it)->GetNonce();
-			Remove(account_address, nonce);
+		for (uint32_t i = 0; i < SHARD_COUNT; i++) {
+			Shard &shard = shards_[i];
+			utils::WriteLockGuard g(shard.lock_);
+			while (!shard.time_queue_.empty()){
+				auto it = shard.time_queue_.begin();
+				if (!(*it)->CheckTimeout(current_time - QUEUE_TRANSACTION_TIMEOUT))
+					break;
+				timeout_txs.emplace_back(*it);
+				std::string account_address = (*it)->GetSourceAddress();
+				int64_t nonce = (*it)->GetNonce();
+				Remove(shard, account_address, nonce);
+			}
 		}
 		LOG_TRACE("CheckTimeoutAndDel last seq(" FMT_I64 ") number(%u)", last_seq, timeout_txs.size());
 	}
 
 	bool TransactionQueue::IsExist(const TransactionFrm::pointer& tx){
-		utils::ReadLockGuard g(lock_);
-		auto account_it1 = queue_by_address_and_nonce_.find(tx->GetSourceAddress());
-		if (account_it1 != queue_by_address_and_nonce_.end()){
-			auto tx_it = account_it1->second.find(tx->GetNonce());
-			if (tx_it != account_it1->second.end()){
-				TransactionFrm::pointer t = *tx_it->second.first;
+		Shard &shard = GetShard(tx->GetSourceAddress());
+		utils::ReadLockGuard g(shard.lock_);
+		auto account_it = shard.accounts_.find(tx->GetSourceAddress());
+		if (account_it != shard.accounts_.end()){
+			auto tx_it = account_it->second.txs_.find(tx->GetNonce());
+			if (tx_it != account_it->second.txs_.end()){
+				TransactionFrm::pointer t = tx_it->second.first;
 				if (t->GetContentHash() == tx->GetContentHash()){
 					return true;
 				}
@@ -287,37 +452,55 @@ namespace bumo {
 	}
 
 	bool TransactionQueue::IsExist(const std::string& hash){
-		utils::ReadLockGuard g(lock_);
-		auto it = queue_by_hash_.find(hash);
-		if (it != queue_by_hash_.end()){
+		//most of the received transactions are new, they are answered without a lock
+		if (!FilterMayContain(hash)) {
+			return false;
+		}
+
+		HashStripe &stripe = GetHashStripe(hash);
+		utils::MutexGuard guard(stripe.lock_);
+		auto it = stripe.queue_by_hash_.find(hash);
+		if (it != stripe.queue_by_hash_.end()){
 			return true;
 		}
 		return false;
 	}
 
 	size_t TransactionQueue::Size() {
-		utils::ReadLockGuard g(lock_);
-		return queue_.size();
+		return (size_t)size_;
 	}
 
 	void TransactionQueue::Query(const uint32_t& num, std::vector<TransactionFrm::pointer>& txs){
-		utils::ReadLockGuard g(lock_);
-		uint32_t count = 0;
-
-		for (auto it = queue_.begin(); it != queue_.end() && count < num; it++) {
-			txs.push_back(*it);
-			count++;
+		for (uint32_t i = 0; i < SHARD_COUNT; i++) {
+			shards_[i].lock_.ReadLock();
+		}
+		SelectExecutable(num, txs);
+		//then the ones waiting for a nonce, oldest first
+		std::unordered_set<TransactionFrm *> selected;
+		for (size_t i = 0; i < txs.size(); i++) {
+			selected.insert(txs[i].get());
+		}
+		for (uint32_t i = 0; i < SHARD_COUNT && txs.size() < num; i++) {
+			const TimeQueue &time_queue = shards_[i].time_queue_;
+			for (auto it = time_queue.begin(); it != time_queue.end() && txs.size() < num; it++) {
+				if (selected.find(it->get()) == selected.end()) {
+					txs.push_back(*it);
+				}
+			}
+		}
+		for (uint32_t i = 0; i < SHARD_COUNT; i++) {
+			shards_[i].lock_.ReadUnlock();
 		}
 	}
 
 	bool TransactionQueue::Query(const std::string& hash, TransactionFrm::pointer& tx){
-		utils::ReadLockGuard g(lock_);
-		auto it = queue_by_hash_.find(hash);
-		if (it != queue_by_hash_.end()){
+		HashStripe &stripe = GetHashStripe(hash);
+		utils::MutexGuard guard(stripe.lock_);
+		auto it = stripe.queue_by_hash_.find(hash);
+		if (it != stripe.queue_by_hash_.end()){
 			tx = it->second;
 			return true;
 		}
 		return false;
 	}
 }
-
@@ -33,7 +33,8 @@ namespace bumo {
 		~TransactionQueue();
 
 		bool Import(TransactionFrm::pointer tx, const int64_t& cur_source_nonce, Result &result);
-		protocol::TransactionEnvSet TopTransaction(uint32_t limit);
+		//the txs for a proposal within the count limit and the txset size limit
+		void TopTransaction(uint32_t limit, std::vector<TransactionFrm::pointer>& txs);
 		uint32_t RemoveTxs(const protocol::TransactionEnvSet& set, bool close_ledger = false);
 		void RemoveTxs(std::vector<TransactionFrm::pointer>& txs, bool close_ledger = false);
 		void CheckTimeout(int64_t current_time, std::vector<TransactionFrm::pointer>& timeout_txs);
@@ -46,22 +47,12 @@ namespace bumo {
 		void Query(const uint32_t& num,std::vector<TransactionFrm::pointer>& txs);
 		bool Query(const std::string& hash,TransactionFrm::pointer& tx);
 	private:
-
-		struct PriorityCompare
-		{
-			TransactionQueue& transaction_queue_;
-			/// Compare transaction by nonce height and fee.
-			bool operator()(TransactionFrm::pointer const& first, TransactionFrm::pointer const& second) const
-			{
-				int64_t const& height1 = first->GetNonce() - transaction_queue_.account_nonce_[first->GetSourceAddress()];
-				int64_t const& height2 = second->GetNonce() - transaction_queue_.account_nonce_[second->GetSourceAddress()];
-				return height1 < height2 || (height1 == height2 && first->GetGasPrice() > second->GetGasPrice());
-			}
-		};
-
-		using PriorityQueue = std::multiset<TransactionFrm::pointer, PriorityCompare>;
-		PriorityQueue queue_;
-
+		//the accounts are partitioned into shards, each shard has its own lock
+		static const uint32_t SHARD_COUNT = 16;
+		//the hashes are striped by their first byte
+		static const uint32_t HASH_STRIPE_COUNT = 16;
+		//counters of the lock free existence filter
+		static const uint32_t HASH_FILTER_SIZE = 1 << 15;
 
 		struct TimePriorityCompare
 		{
@@ -74,26 +65,75 @@ namespace bumo {
 
 		//time order
 		using TimeQueue = std::multiset<TransactionFrm::pointer, TimePriorityCompare>;
-		TimeQueue time_queue_;
 
-		using QueueIterPair = std::pair<PriorityQueue::iterator, TimeQueue::iterator>;
-		using QueueByNonce = std::map<int64_t, QueueIterPair>;
-		using QueueByAddressAndNonce = std::unordered_map<std::string, QueueByNonce>;
-		QueueByAddressAndNonce queue_by_address_and_nonce_;
+		//the transactions of an account in nonce order
+		using QueueByNonce = std::map<int64_t, std::pair<TransactionFrm::pointer, TimeQueue::iterator>>;
+		struct AccountQueue {
+			AccountQueue() : nonce_(0), head_gas_price_(-1), tail_gas_price_(-1) {}
+
+			QueueByNonce txs_;
+			//record account system nonce
+			int64_t nonce_;
+			//keys of the account in the head and tail sets, -1 : not in the set
+			int64_t head_gas_price_;
+			int64_t tail_gas_price_;
+		};
+
+		//gas price and address of an account
+		using AccountKey = std::pair<int64_t, std::string>;
+		struct HeadCompare
+		{
+			/// Higher gas price first
+			bool operator()(AccountKey const& first, AccountKey const& second) const
+			{
+				return first.first > second.first || (first.first == second.first && first.second < second.second);
+			}
+		};
+		using HeadSet = std::set<AccountKey, HeadCompare>;
+		using TailSet = std::set<AccountKey>;
+
+		struct Shard {
+			TimeQueue time_queue_;
+			std::unordered_map<std::string, AccountQueue> accounts_;
+			//accounts whose next nonce is queued, by the gas price of that transaction
+			HeadSet heads_;
+			//all accounts by the gas price of their last transaction, the lowest is dropped first
+			TailSet tails_;
+			utils::ReadWriteLock lock_;
+		};
+		Shard shards_[SHARD_COUNT];
 
-		std::unordered_map<std::string, TransactionFrm::pointer> queue_by_hash_;
-		//record account system nonce
-		std::unordered_map<std::string, int64_t> account_nonce_;
+		struct HashStripe {
+			std::unordered_map<std::string, TransactionFrm::pointer> queue_by_hash_;
+			utils::Mutex lock_;
+		};
+		HashStripe hash_stripes_[HASH_STRIPE_COUNT];
+		volatile int64_t hash_filter_[HASH_FILTER_SIZE];
 
+		volatile int64_t size_;
 		uint32_t queue_limit_;
 		//Maximum number of transaction per account
 		uint32_t account_txs_limit_;
-
-		std::pair<bool, TransactionFrm::pointer> Remove(const std::string& account_address,const int64_t& nonce);
-		std::pair<bool, TransactionFrm::pointer> Remove(QueueByAddressAndNonce::iterator& account_it, QueueByNonce::iterator& tx_it, bool del_empty = true);
-		void Insert(TransactionFrm::pointer const& tx);
-
-		utils::ReadWriteLock lock_;
+		//serialize the evictions over the queue limit
+		utils::Mutex evict_lock_;
+
+		Shard &GetShard(const std::string& account_address);
+		HashStripe &GetHashStripe(const std::string& hash);
+		void FilterAdd(const std::string& hash, bool add);
+		bool FilterMayContain(const std::string& hash);
+
+		//take the account out of the head and tail sets before it changes, and put it back after
+		void Unlink(Shard &shard, const std::string& account_address, AccountQueue &account);
+		void Link(Shard &shard, const std::string& account_address, AccountQueue &account);
+
+		std::pair<bool, TransactionFrm::pointer> Remove(Shard &shard, const std::string& account_address, const int64_t& nonce);
+		//remove without relinking the account
+		TransactionFrm::pointer Erase(Shard &shard, AccountQueue &account, QueueByNonce::iterator& tx_it);
+		void Insert(Shard &shard, AccountQueue &account, TransactionFrm::pointer const& tx);
+		//drop the lowest transaction of all shards, return it
+		TransactionFrm::pointer EvictLowest();
+		//executable transactions by gas price, each account in nonce order. all shards are read locked by the caller
+		void SelectExecutable(uint32_t limit, std::vector<TransactionFrm::pointer>& txs);
 	};
 }
 
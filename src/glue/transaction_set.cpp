@@ -14,22 +14,25 @@
 */
 
 #include "transaction_set.h"
+#include <google/protobuf/io/coded_stream.h>
 
 namespace bumo {
 	TransactionSetFrm::TransactionSetFrm(const protocol::TransactionEnvSet &env) {
 		raw_txs_ = env;
+		byte_size_ = raw_txs_.ByteSize();
 	}
 
-	TransactionSetFrm::TransactionSetFrm() {
+	TransactionSetFrm::TransactionSetFrm() : byte_size_(0) {
 	}
 
 	TransactionSetFrm::~TransactionSetFrm() {}
 	int32_t TransactionSetFrm::Add(const TransactionFrm::pointer &tx) {
-		if (raw_txs_.ByteSize() + tx->GetTransactionEnv().ByteSize() >= General::TXSET_LIMIT_SIZE) {
-			LOG_ERROR("Txset byte size(%d) will be exceed than limit(%d), stop added current tx(size:%d)", 
-				raw_txs_.ByteSize(), 
+		int64_t entry_size = EntrySize(tx);
+		if (byte_size_ + entry_size >= General::TXSET_LIMIT_SIZE) {
+			LOG_ERROR("Txset byte size(" FMT_I64 ") will be exceed than limit(%d), stop added current tx(size:" FMT_I64 ")", 
+				byte_size_, 
 				General::TXSET_LIMIT_SIZE,
-				tx->GetTransactionEnv().ByteSize());
+				entry_size);
 			return 0;
 		} 
 
@@ -60,7 +63,8 @@ namespace bumo {
 		}
 
 		topic_seqs_[tx->GetSourceAddress()] = tx->GetNonce();
-		*raw_txs_.add_txs() = tx->GetProtoTxEnv();
+		*raw_txs_.add_txs() = tx->GetTransactionEnv();
+		byte_size_ += entry_size;
 		return 1;
 	}
 
@@ -76,6 +80,20 @@ namespace bumo {
 		return raw_txs_;
 	}
 
+	int64_t TransactionSetFrm::EntrySize(const TransactionFrm::pointer &tx) {
+		//one byte tag of the txs field, the length and the env serialized at initialization
+		int64_t size = tx->GetFullData().size();
+		return 1 + google::protobuf::io::CodedOutputStream::VarintSize32((uint32_t)size) + size;
+	}
+
+	void TransactionSetFrm::ToProto(const std::vector<TransactionFrm::pointer> &txs, protocol::TransactionEnvSet &set) {
+		set.clear_txs();
+		set.mutable_txs()->Reserve(txs.size());
+		for (size_t i = 0; i < txs.size(); i++) {
+			*set.add_txs() = txs[i]->GetTransactionEnv();
+		}
+	}
+
 	TopicKey::TopicKey() : sequence_(0) {}
 	TopicKey::TopicKey(const std::string &topic, int64_t sequence) : topic_(topic), sequence_(sequence) {}
 	TopicKey::~TopicKey() {}
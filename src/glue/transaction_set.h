@@ -26,6 +26,7 @@ namespace bumo {
 	class TransactionSetFrm {
 		protocol::TransactionEnvSet raw_txs_;
 		std::map<std::string, int64_t> topic_seqs_;
+		int64_t byte_size_; //encoded size of raw_txs_, kept as the txs are added
 	public:
 		TransactionSetFrm();
 		TransactionSetFrm(const protocol::TransactionEnvSet &env);
@@ -34,6 +35,11 @@ namespace bumo {
 		std::string GetSerializeString() const;
 		int32_t Size() const;
 		const protocol::TransactionEnvSet &GetRaw() const;
+
+		//encoded size of the tx as an entry of a TransactionEnvSet
+		static int64_t EntrySize(const TransactionFrm::pointer &tx);
+		//copy the envs into the set, once when it is serialized
+		static void ToProto(const std::vector<TransactionFrm::pointer> &txs, protocol::TransactionEnvSet &set);
 	};
 	typedef std::map<int64_t, TransactionFrm::pointer> TransactionFrmMap;
 
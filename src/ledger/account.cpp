@@ -36,6 +36,7 @@ namespace bumo {
 		account_info_.CopyFrom(account->ProtocolAccount());
 		assets_ = account->assets_;
 		metadata_ = account->metadata_;
+		snapshot_ = account->snapshot_;
 	}
 
 	AccountFrm::~AccountFrm() {
@@ -185,7 +186,7 @@ namespace bumo {
 		KVTrie trie;
 		auto batch = std::make_shared<WRITE_BATCH>();
 		std::string prefix = ComposePrefix(General::ASSET_PREFIX, DecodeAddress(account_info_.address()));
-		trie.Init(Storage::Instance().account_db(), batch, prefix, 1);
+		trie.Init(Storage::Instance().account_db(), batch, prefix, account_info_.assets_hash(), &LedgerManager::Instance().node_cache_, snapshot_);
 		std::vector<std::string> values;
 		trie.GetAll("", values);
 		for (size_t i = 0; i < values.size(); i++){
@@ -199,7 +200,7 @@ namespace bumo {
 		KVTrie trie;
 		auto batch = std::make_shared<WRITE_BATCH>();
 		std::string prefix = ComposePrefix(General::METADATA_PREFIX, DecodeAddress(account_info_.address()));
-		trie.Init(Storage::Instance().account_db(), batch, prefix, 1);
+		trie.Init(Storage::Instance().account_db(), batch, prefix, account_info_.metadatas_hash(), &LedgerManager::Instance().node_cache_, snapshot_);
 		std::vector<std::string> values;
 		trie.GetAll("", values);
 		for (size_t i = 0; i < values.size(); i++){
@@ -223,7 +224,7 @@ namespace bumo {
 		auto batch = std::make_shared<WRITE_BATCH>();
 		std::string asset_prefix = ComposePrefix(General::ASSET_PREFIX, DecodeAddress(account_info_.address()));
 		KVTrie trie;
-		trie.Init(Storage::Instance().account_db(), batch, asset_prefix, 1);
+		trie.Init(Storage::Instance().account_db(), batch, asset_prefix, account_info_.assets_hash(), &LedgerManager::Instance().node_cache_, snapshot_);
 
 		auto asset_key_str = asset_key.SerializeAsString();
 		std::string buff;
@@ -265,7 +266,7 @@ namespace bumo {
 		auto batch = std::make_shared<WRITE_BATCH>();
 		KVTrie trie;
 		std::string prefix = ComposePrefix(General::METADATA_PREFIX, DecodeAddress(account_info_.address()));
-		trie.Init(Storage::Instance().account_db(), batch, prefix, 1);
+		trie.Init(Storage::Instance().account_db(), batch, prefix, account_info_.metadatas_hash(), &LedgerManager::Instance().node_cache_, snapshot_);
 
 		std::string buff;
 		if (!trie.Get(binkey, buff)){
@@ -301,17 +302,16 @@ namespace bumo {
 	void AccountFrm::UpdateHash(std::shared_ptr<WRITE_BATCH> batch){
 		KVTrie trie_asset;
 		std::string asset_prefix = ComposePrefix(General::ASSET_PREFIX, DecodeAddress(account_info_.address()));
-		trie_asset.Init(Storage::Instance().account_db(), batch, asset_prefix, 1);
+		trie_asset.Init(Storage::Instance().account_db(), batch, asset_prefix, account_info_.assets_hash(), &LedgerManager::Instance().node_cache_, snapshot_);
 
 		KVTrie trie_metadata;
 		std::string meta_prefix = ComposePrefix(General::METADATA_PREFIX, DecodeAddress(account_info_.address()));
-		trie_metadata.Init(Storage::Instance().account_db(), batch, meta_prefix, 1);
+		trie_metadata.Init(Storage::Instance().account_db(), batch, meta_prefix, account_info_.metadatas_hash(), &LedgerManager::Instance().node_cache_, snapshot_);
 
 		auto& map = assets_;
 		for (auto it = map.begin(); it != map.end(); it++){
 			auto action = it->second.action_;
 			auto asset = it->second.data_;
-			Json::Value tmp = Proto2Json(asset);
 			switch (action)
 			{
 			case utils::ChangeAction::ADD:
@@ -359,6 +359,10 @@ namespace bumo {
 		account_info_.set_nonce(new_nonce);
 	}
 
+	void AccountFrm::SetSnapshot(KeyValueDbSnapshot::pointer snapshot){
+		snapshot_ = snapshot;
+	}
+
 	AccountFrm::pointer AccountFrm::CreatAccountFrm(const std::string& account_address, int64_t balance) {
 		protocol::Account acc;
 		acc.set_address(account_address);
@@ -109,6 +109,9 @@ namespace bumo {
 		int64_t GetAccountBalance() const;
 		bool AddBalance(int64_t amount);
 		static AccountFrm::pointer CreatAccountFrm(const std::string& account_address, int64_t balance);
+
+		//read the assets and metadata from the snapshot instead of the live db
+		void SetSnapshot(KeyValueDbSnapshot::pointer snapshot);
 	public:
 
 		template <class T>
@@ -121,6 +124,7 @@ namespace bumo {
 		std::map<std::string, DataCache<protocol::KeyPair>> metadata_;
 	private:
 		protocol::Account	account_info_;
+		KeyValueDbSnapshot::pointer snapshot_;
 	};
 
 }
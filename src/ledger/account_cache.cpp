@@ -0,0 +1,37 @@
+/*
+	bumo is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	bumo is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with bumo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "account_cache.h"
+
+namespace bumo {
+	void AccountCache::Set(const std::string &address, int64_t version, const protocol::Account &account) {
+		//a ledger closed after the read, the account may be changed
+		utils::CountedLruCache<std::string, pointer>::Set(address, version, std::make_shared<protocol::Account>(account));
+	}
+
+	void AccountCache::Update(int64_t version, const std::vector<std::shared_ptr<AccountFrm>> &accounts) {
+		//the changed accounts are likely read again in the next ledger
+		std::vector<Item> items;
+		for (size_t i = 0; i < accounts.size(); i++) {
+			items.push_back(Item(accounts[i]->GetAccountAddress(), std::make_shared<protocol::Account>(accounts[i]->GetProtoAccount())));
+		}
+		utils::CountedLruCache<std::string, pointer>::Update(version, items);
+	}
+
+	void AccountCache::GetModuleStatus(Json::Value &data) {
+		utils::CountedLruCache<std::string, pointer>::GetModuleStatus(data);
+		data["version"] = GetVersion();
+	}
+}
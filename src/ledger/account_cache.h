@@ -0,0 +1,44 @@
+/*
+	bumo is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	bumo is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with bumo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ACCOUNT_CACHE_H_
+#define ACCOUNT_CACHE_H_
+
+#include <utils/counted_lru_cache.h>
+#include <proto/cpp/chain.pb.h>
+#include <json/json.h>
+#include "account.h"
+
+namespace bumo {
+
+	//decoded accounts of the last closed ledger, so the hot accounts are read
+	//without walking the account trie and parsing them again.
+	//the version is the sequence of the last closed ledger, an account read at an
+	//older version is not cached, and closing a ledger replaces the accounts it changed
+	class AccountCache : public utils::CountedLruCache<std::string, std::shared_ptr<const protocol::Account>> {
+	public:
+		typedef std::shared_ptr<const protocol::Account> pointer;
+
+		//take the version before reading the trie, and set the account read with it
+		void Set(const std::string &address, int64_t version, const protocol::Account &account);
+
+		//the ledger of the version is closed with the accounts changed
+		void Update(int64_t version, const std::vector<std::shared_ptr<AccountFrm>> &accounts);
+
+		void GetModuleStatus(Json::Value &data);
+	};
+}
+
+#endif
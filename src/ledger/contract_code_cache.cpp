@@ -0,0 +1,121 @@
+/*
+	bumo is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	bumo is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with bumo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <common/general.h>
+#include <common/storage.h>
+#include "contract_code_cache.h"
+
+namespace bumo {
+	ContractCodeCache::ContractCodeCache() :
+		persist_(false),
+		persist_hit_count_(0),
+		rejected_count_(0) {}
+
+	ContractCodeCache::~ContractCodeCache() {}
+
+	void ContractCodeCache::Initialize(size_t capacity, bool persist) {
+		cache_.Initialize(capacity);
+		persist_ = persist && capacity > 0;
+		LoadPersisted(capacity);
+	}
+
+	void ContractCodeCache::LoadPersisted(size_t capacity) {
+		KeyValueDb *db = Storage::Instance().keyvalue_db();
+		std::string prefix = ComposePrefix(General::CONTRACT_CODE_CACHE_PREFIX, "");
+		std::vector<std::string> stale_keys;
+		size_t loaded = 0;
+
+#ifdef WIN32
+		leveldb::Iterator *it = (leveldb::Iterator*)db->NewIterator();
+#else
+		rocksdb::Iterator *it = (rocksdb::Iterator*)db->NewIterator();
+#endif
+		for (it->Seek(prefix); it->Valid() && it->key().starts_with(prefix); it->Next()) {
+			if (persist_ && loaded < capacity) {
+				cache_.Set(it->key().ToString().substr(prefix.size()), it->value().ToString());
+				loaded++;
+			}
+			else {
+				stale_keys.push_back(it->key().ToString());
+			}
+		}
+		delete it;
+
+		for (size_t i = 0; i < stale_keys.size(); i++) {
+			db->Delete(stale_keys[i]);
+		}
+		LOG_INFO("Contract code cache loaded(" FMT_SIZE ") persisted entries, deleted(" FMT_SIZE ")", loaded, stale_keys.size());
+	}
+
+	void ContractCodeCache::SetLocal(const std::string &code_hash, const std::string &data) {
+		std::string evicted;
+		if (cache_.Set(code_hash, data, &evicted) && persist_) {
+			Storage::Instance().keyvalue_db()->Delete(ComposePrefix(General::CONTRACT_CODE_CACHE_PREFIX, evicted));
+		}
+	}
+
+	bool ContractCodeCache::Enabled() {
+		return cache_.Enabled();
+	}
+
+	bool ContractCodeCache::Get(const std::string &code_hash, std::string &data) {
+		if (cache_.Get(code_hash, data)) {
+			return true;
+		}
+
+		if (!persist_ || Storage::Instance().keyvalue_db()->Get(ComposePrefix(General::CONTRACT_CODE_CACHE_PREFIX, code_hash), data) <= 0) {
+			return false;
+		}
+
+		//the entry of an earlier run, kept in memory again
+		do {
+			utils::MutexGuard guard(mutex_);
+			persist_hit_count_++;
+		} while (false);
+		SetLocal(code_hash, data);
+		return true;
+	}
+
+	void ContractCodeCache::Set(const std::string &code_hash, const std::string &data) {
+		if (!cache_.Enabled()) {
+			return;
+		}
+		SetLocal(code_hash, data);
+
+		if (persist_ && !Storage::Instance().keyvalue_db()->Put(ComposePrefix(General::CONTRACT_CODE_CACHE_PREFIX, code_hash), data)) {
+			LOG_ERROR("Write contract code cache failed, %s", Storage::Instance().keyvalue_db()->error_desc().c_str());
+		}
+	}
+
+	void ContractCodeCache::Remove(const std::string &code_hash) {
+		do {
+			utils::MutexGuard guard(mutex_);
+			rejected_count_++;
+		} while (false);
+		cache_.Erase(code_hash);
+
+		if (persist_) {
+			Storage::Instance().keyvalue_db()->Delete(ComposePrefix(General::CONTRACT_CODE_CACHE_PREFIX, code_hash));
+		}
+	}
+
+	void ContractCodeCache::GetModuleStatus(Json::Value &data) {
+		cache_.GetModuleStatus(data);
+		data["persist"] = persist_;
+		utils::MutexGuard guard(mutex_);
+		data["persist_hit_count"] = persist_hit_count_;
+		data["rejected_count"] = rejected_count_;
+	}
+}
@@ -0,0 +1,56 @@
+/*
+	bumo is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	bumo is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with bumo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CONTRACT_CODE_CACHE_H_
+#define CONTRACT_CODE_CACHE_H_
+
+#include <utils/counted_lru_cache.h>
+#include <json/json.h>
+
+namespace bumo {
+
+	//v8 code caches of the contracts, keyed by the hash of the code, so the same
+	//contract is not parsed again on every call. v8 checks an entry against the
+	//source and its own version, a rejected entry is dropped and produced again.
+	//with persist the entries are kept in the keyvalue db for a restart, the db
+	//holds the same entries as the memory, an evicted entry is deleted from both
+	class ContractCodeCache {
+	public:
+		ContractCodeCache();
+		~ContractCodeCache();
+
+		//capacity 0 disables the cache
+		void Initialize(size_t capacity, bool persist);
+		bool Enabled();
+
+		bool Get(const std::string &code_hash, std::string &data);
+		void Set(const std::string &code_hash, const std::string &data);
+		void Remove(const std::string &code_hash);
+
+		void GetModuleStatus(Json::Value &data);
+	private:
+		//load the persisted entries up to the capacity, the others are deleted
+		void LoadPersisted(size_t capacity);
+		void SetLocal(const std::string &code_hash, const std::string &data);
+
+		utils::CountedLruCache<std::string, std::string> cache_;
+		bool persist_;
+		utils::Mutex mutex_;
+		int64_t persist_hit_count_;
+		int64_t rejected_count_;
+	};
+}
+
+#endif
@@ -135,22 +135,94 @@ namespace bumo{
 
 	v8::Platform* V8Contract::platform_ = nullptr;
 	v8::Isolate::CreateParams V8Contract::create_params_;
+	utils::Mutex V8Contract::isolate_pool_mutex_;
+	std::map<size_t, std::list<v8::Isolate*>> V8Contract::isolate_pools_;
+	int64_t V8Contract::isolate_heap_size_ = 0;
+	v8::StartupData V8Contract::snapshot_blob_ = { nullptr, 0 };
+	std::vector<intptr_t> V8Contract::external_references_;
+	bool V8Contract::jslint_snapshot_ = false;
 
 	V8Contract::V8Contract(bool readonly, const ContractParameter &parameter) : Contract(readonly,parameter) {
 		type_ = TYPE_V8;
-		isolate_ = v8::Isolate::New(create_params_);
+		terminated_ = false;
+		isolate_ = AcquireIsolate();
 
 		utils::MutexGuard guard(isolate_to_contract_mutex_);
 		isolate_to_contract_[isolate_] = this;
 	}
 
 	V8Contract::~V8Contract() {
-		utils::MutexGuard guard(isolate_to_contract_mutex_);
-		isolate_to_contract_.erase(isolate_);
-		isolate_->Dispose();
+		do {
+			utils::MutexGuard guard(isolate_to_contract_mutex_);
+			isolate_to_contract_.erase(isolate_);
+		} while (false);
+
+		//a terminated isolate may still hold the termination for the next script
+		ReleaseIsolate(isolate_, !terminated_);
 		isolate_ = NULL;
 	}
 
+	v8::Isolate *V8Contract::AcquireIsolate() {
+		v8::Isolate *isolate = NULL;
+		do {
+			utils::MutexGuard guard(isolate_pool_mutex_);
+			std::list<v8::Isolate*> &pool = isolate_pools_[utils::Thread::current_thread_id()];
+			if (pool.empty()) {
+				break;
+			}
+
+			isolate = pool.front();
+			pool.pop_front();
+		} while (false);
+
+		if (!isolate) {
+			isolate = v8::Isolate::New(create_params_);
+
+			v8::HeapStatistics stats;
+			isolate->GetHeapStatistics(&stats);
+			utils::MutexGuard guard(isolate_pool_mutex_);
+			isolate_heap_size_ = MAX(isolate_heap_size_, (int64_t)stats.used_heap_size());
+		}
+
+		//the stack usage of the contract is counted from here on the stack of this thread, as for a new isolate
+		v8::V8InternalInfo internal_info;
+		isolate->GetV8InternalInfo(internal_info);
+		isolate->SetStackLimit(reinterpret_cast<uintptr_t>(&internal_info) - internal_info.max_stack_size);
+		return isolate;
+	}
+
+	void V8Contract::ReleaseIsolate(v8::Isolate *isolate, bool reusable) {
+		if (reusable) {
+			//the contexts of the call are garbage now, the next call must start on the heap of a new isolate
+			v8::HeapStatistics stats;
+			do {
+				v8::Isolate::Scope isolate_scope(isolate);
+				isolate->ContextDisposedNotification();
+				isolate->LowMemoryNotification();
+				isolate->GetHeapStatistics(&stats);
+			} while (false);
+
+			utils::MutexGuard guard(isolate_pool_mutex_);
+			std::list<v8::Isolate*> &pool = isolate_pools_[utils::Thread::current_thread_id()];
+			if ((int64_t)stats.used_heap_size() <= isolate_heap_size_ && pool.size() < isolate_pool_max_) {
+				pool.push_back(isolate);
+				return;
+			}
+		}
+
+		isolate->Dispose();
+	}
+
+	void V8Contract::DisposeIsolates() {
+		utils::MutexGuard guard(isolate_pool_mutex_);
+		for (auto pool = isolate_pools_.begin(); pool != isolate_pools_.end(); pool++) {
+			for (std::list<v8::Isolate*>::iterator iter = pool->second.begin(); iter != pool->second.end(); iter++) {
+				(*iter)->Dispose();
+			}
+		}
+		isolate_pools_.clear();
+	}
+
 	bool V8Contract::LoadJsLibSource() {
 		std::string lib_path = utils::String::Format("%s/jslib", utils::File::GetBinHome().c_str());
 		utils::FileAttributes files;
@@ -245,15 +317,131 @@ namespace bumo{
 		create_params_.array_buffer_allocator =
 			v8::ArrayBuffer::Allocator::NewDefaultAllocator();
 
+		if (!CreateSnapshot()) {
+			LOG_WARN("Create v8 snapshot failed, the contexts are built for every call");
+		}
+
 		return true;
 	}
 
+	bool V8Contract::CreateSnapshot() {
+		//the snapshot refers to the callbacks of the global templates
+		std::map<std::string, v8::FunctionCallback>::iterator itr = js_func_read_.begin();
+		for (; itr != js_func_read_.end(); itr++) {
+			external_references_.push_back((intptr_t)itr->second);
+		}
+		for (itr = js_func_write_.begin(); itr != js_func_write_.end(); itr++) {
+			external_references_.push_back((intptr_t)itr->second);
+		}
+		external_references_.push_back(0);
+
+		std::map<std::string, std::string>::iterator find_jslint_source = jslib_sources.find("jslint.js");
+		bool ret = true;
+		bool jslint = false;
+		v8::SnapshotCreator creator(external_references_.data());
+		v8::Isolate *isolate = creator.GetIsolate();
+		do {
+			v8::HandleScope handle_scope(isolate);
+			creator.SetDefaultContext(v8::Context::New(isolate));
+
+			//the same steps as a call, done once
+			for (int32_t index = SNAPSHOT_WRITE; index <= SNAPSHOT_JSLINT && ret; index++) {
+				v8::Local<v8::Context> context = CreateContext(isolate, index == SNAPSHOT_READONLY);
+				v8::Context::Scope context_scope(context);
+				Json::Value error_msg;
+				if (index == SNAPSHOT_JSLINT) {
+					v8::TryCatch try_catch(isolate);
+					v8::Local<v8::Script> script;
+					v8::Local<v8::Value> result;
+					jslint = find_jslint_source != jslib_sources.end() &&
+						v8::Script::Compile(context, v8::String::NewFromUtf8(isolate, find_jslint_source->second.c_str())).ToLocal(&script) &&
+						script->Run(context).ToLocal(&result);
+				}
+				else if (!RemoveRandom(isolate, error_msg)) {
+					ret = false;
+					break;
+				}
+
+				ret = creator.AddContext(context) == (size_t)index;
+			}
+		} while (false);
+
+		//the blob is created out of any handle scope
+		v8::StartupData blob = creator.CreateBlob(v8::SnapshotCreator::FunctionCodeHandling::kClear);
+		if (!ret || blob.data == nullptr) {
+			delete[] blob.data;
+			return false;
+		}
+
+		snapshot_blob_ = blob;
+		jslint_snapshot_ = jslint;
+		create_params_.snapshot_blob = &snapshot_blob_;
+		create_params_.external_references = external_references_.data();
+		LOG_INFO("Create v8 snapshot ok, size(%d)", snapshot_blob_.raw_size);
+		return true;
+	}
+
+	bool V8Contract::CompileCode(v8::Local<v8::Context> context, const std::string &code, const v8::ScriptOrigin &origin, v8::Local<v8::Script> &script) {
+		v8::Isolate *isolate = context->GetIsolate();
+		v8::Local<v8::String> v8src = v8::String::NewFromUtf8(isolate, code.c_str());
+		ContractCodeCache &cache = ContractManager::Instance().code_cache_;
+		if (!cache.Enabled()) {
+			v8::ScriptCompiler::Source source(v8src, origin);
+			return v8::ScriptCompiler::Compile(context, &source).ToLocal(&script);
+		}
+
+		std::string code_hash = HashWrapper::Crypto(code);
+		std::string data;
+		if (cache.Get(code_hash, data)) {
+			//the source owns the cached data object, not the buffer
+			v8::ScriptCompiler::Source source(v8src, origin,
+				new v8::ScriptCompiler::CachedData((const uint8_t *)data.data(), (int)data.size()));
+			if (!v8::ScriptCompiler::Compile(context, &source, v8::ScriptCompiler::kConsumeCodeCache).ToLocal(&script)) {
+				return false;
+			}
+			if (source.GetCachedData()->rejected) {
+				cache.Remove(code_hash);
+			}
+			return true;
+		}
+
+		v8::ScriptCompiler::Source source(v8src, origin);
+		if (!v8::ScriptCompiler::Compile(context, &source, v8::ScriptCompiler::kProduceCodeCache).ToLocal(&script)) {
+			return false;
+		}
+		const v8::ScriptCompiler::CachedData *produced = source.GetCachedData();
+		if (produced != nullptr && produced->length > 0) {
+			cache.Set(code_hash, std::string((const char *)produced->data, produced->length));
+		}
+		return true;
+	}
+
+	v8::Local<v8::Context> V8Contract::CreateSandboxContext(v8::Isolate* isolate, bool readonly, Json::Value &error_msg) {
+		v8::Local<v8::Context> context;
+		if (snapshot_blob_.data != nullptr &&
+			v8::Context::FromSnapshot(isolate, readonly ? SNAPSHOT_READONLY : SNAPSHOT_WRITE).ToLocal(&context)) {
+			return context;
+		}
+
+		context = CreateContext(isolate, readonly);
+		v8::Context::Scope context_scope(context);
+		if (!RemoveRandom(isolate, error_msg)) {
+			return v8::Local<v8::Context>();
+		}
+		return context;
+	}
+
 	bool V8Contract::ExecuteCode(const char* fname){
 		v8::Isolate::Scope isolate_scope(isolate_);
 		v8::HandleScope handle_scope(isolate_);
 		v8::TryCatch try_catch(isolate_);
 
-		v8::Local<v8::Context> context = CreateContext(isolate_, false);
+		Json::Value error_random;
+		v8::Local<v8::Context> context = CreateSandboxContext(isolate_, false, error_random);
+		if (context.IsEmpty()) {
+			result_.set_desc(error_random.toFastString());
+			return false;
+		}
 
 		v8::Context::Scope context_scope(context);
 
@@ -303,22 +491,15 @@ namespace bumo{
 			v8::String::NewFromUtf8(isolate_, block_timestamp_name_.c_str(), v8::NewStringType::kNormal).ToLocalChecked(),
 			timestamp_v8);
 
-		v8::Local<v8::String> v8src = v8::String::NewFromUtf8(isolate_, parameter_.code_.c_str());
 		v8::Local<v8::Script> compiled_script;
 
 		do {
-			Json::Value error_random;
-			if (!RemoveRandom(isolate_, error_random)) {
-				result_.set_desc(error_random.toFastString());
-				break;
-			}
-
 			v8::Local<v8::String> check_time_name(
 				v8::String::NewFromUtf8(context->GetIsolate(), "__enable_check_time__",
 				v8::NewStringType::kNormal).ToLocalChecked());
 			v8::ScriptOrigin origin_check_time_name(check_time_name);
 
-			if (!v8::Script::Compile(context, v8src, &origin_check_time_name).ToLocal(&compiled_script)) {
+			if (!CompileCode(context, parameter_.code_, origin_check_time_name, compiled_script)) {
 				result_.set_desc(ReportException(isolate_, &try_catch).toFastString());
 				break;
 			}
@@ -376,6 +557,7 @@ namespace bumo{
 	}
 
 	bool V8Contract::Cancel() {
+		terminated_ = true;
 		v8::V8::TerminateExecution(isolate_);
 		return true;
 	}
@@ -390,36 +572,43 @@ namespace bumo{
 		v8::HandleScope handle_scope(isolate_);
 		v8::TryCatch try_catch(isolate_);
 
-		v8::Local<v8::Context> context = CreateContext(isolate_, false);
+		//the snapshot has jslint evaluated already
+		v8::Local<v8::Context> context;
+		bool jslint_loaded = jslint_snapshot_ && v8::Context::FromSnapshot(isolate_, SNAPSHOT_JSLINT).ToLocal(&context);
+		if (!jslint_loaded) {
+			context = CreateContext(isolate_, false);
+		}
 		v8::Context::Scope context_scope(context);
 
-		std::string jslint_file = "jslint.js";
-		std::map<std::string, std::string>::iterator find_jslint_source = jslib_sources.find(jslint_file);
-		if (find_jslint_source == jslib_sources.end()) {
-			Json::Value json_result;
-			json_result["exception"] = utils::String::Format("Can't find the include file(%s) in jslib directory", jslint_file.c_str());
-			result_.set_code(protocol::ERRCODE_CONTRACT_SYNTAX_ERROR);
-			result_.set_desc(json_result.toFastString());
-			LOG_ERROR("Can't find the include file(%s) in jslib directory", jslint_file.c_str());
-			return false;
-		}
+		if (!jslint_loaded) {
+			std::string jslint_file = "jslint.js";
+			std::map<std::string, std::string>::iterator find_jslint_source = jslib_sources.find(jslint_file);
+			if (find_jslint_source == jslib_sources.end()) {
+				Json::Value json_result;
+				json_result["exception"] = utils::String::Format("Can't find the include file(%s) in jslib directory", jslint_file.c_str());
+				result_.set_code(protocol::ERRCODE_CONTRACT_SYNTAX_ERROR);
+				result_.set_desc(json_result.toFastString());
+				LOG_ERROR("Can't find the include file(%s) in jslib directory", jslint_file.c_str());
+				return false;
+			}
 
-		v8::Local<v8::String> v8src = v8::String::NewFromUtf8(isolate_, find_jslint_source->second.c_str());
-		v8::Local<v8::Script> compiled_script;
-		if (!v8::Script::Compile(context, v8src).ToLocal(&compiled_script)) {
-			result_.set_code(protocol::ERRCODE_CONTRACT_SYNTAX_ERROR);
-			result_.set_desc(ReportException(isolate_, &try_catch).toFastString());
-			LOG_ERROR("%s", result_.desc().c_str());
-			return false;
-		}
-		Json::Value error_desc_f;
-		v8::Local<v8::Value> result;
-		if (!compiled_script->Run(context).ToLocal(&result)) {
-			result_.set_code(protocol::ERRCODE_CONTRACT_SYNTAX_ERROR);
-			result_.set_desc(ReportException(isolate_, &try_catch).toFastString());
-			LOG_ERROR("%s", result_.desc().c_str());
-			return false;
+			v8::Local<v8::String> v8src = v8::String::NewFromUtf8(isolate_, find_jslint_source->second.c_str());
+			v8::Local<v8::Script> compiled_script;
+			if (!v8::Script::Compile(context, v8src).ToLocal(&compiled_script)) {
+				result_.set_code(protocol::ERRCODE_CONTRACT_SYNTAX_ERROR);
+				result_.set_desc(ReportException(isolate_, &try_catch).toFastString());
+				LOG_ERROR("%s", result_.desc().c_str());
+				return false;
+			}
+			v8::Local<v8::Value> result;
+			if (!compiled_script->Run(context).ToLocal(&result)) {
+				result_.set_code(protocol::ERRCODE_CONTRACT_SYNTAX_ERROR);
+				result_.set_desc(ReportException(isolate_, &try_catch).toFastString());
+				LOG_ERROR("%s", result_.desc().c_str());
+				return false;
+			}
 		}
+
 		v8::Local<v8::String> process_name = v8::String::NewFromUtf8(
 			isolate_, V8Contract::call_jslint_, v8::NewStringType::kNormal, strlen(V8Contract::call_jslint_)).ToLocalChecked();
 
@@ -460,7 +649,7 @@ namespace bumo{
 
 		Json::Reader reader;
 		Json::Value call_result_json;
-		if (!reader.parse(std::string(ToCString(v8::String::Utf8Value(callRet))), call_result_json)) {
+		if (!reader.parse(JsToString(callRet), call_result_json)) {
 			Json::Value json_result;
 			json_result["exception"] = utils::String::Format("Parse Jslint result failed, (%s)", reader.getFormatedErrorMessages().c_str());
 			result_.set_code(protocol::ERRCODE_CONTRACT_SYNTAX_ERROR);
@@ -487,7 +676,13 @@ namespace bumo{
 		v8::HandleScope    handle_scope(isolate_);
 		v8::TryCatch       try_catch(isolate_);
 
-		v8::Local<v8::Context>       context = CreateContext(isolate_, true);
+		Json::Value error_desc_f;
+		v8::Local<v8::Context>       context = CreateSandboxContext(isolate_, true, error_desc_f);
+		if (context.IsEmpty()) {
+			Json::Value &error_obj = js_result["error"];
+			error_obj["data"] = error_desc_f;
+			return false;
+		}
 		v8::Context::Scope            context_scope(context);
 
 		auto string_sender = v8::String::NewFromUtf8(isolate_, parameter_.sender_.c_str(), v8::NewStringType::kNormal).ToLocalChecked();
@@ -516,22 +711,16 @@ namespace bumo{
 			timestamp_v8);
 
 
-		v8::Local<v8::String> v8src = v8::String::NewFromUtf8(isolate_, parameter_.code_.c_str());
 		v8::Local<v8::Script> compiled_script;
 
-		Json::Value error_desc_f;
 		Json::Value temp_result;
 		do {
-			if (!RemoveRandom(isolate_, error_desc_f)) {
-				break;
-			}
-
 			v8::Local<v8::String> check_time_name(
 				v8::String::NewFromUtf8(context->GetIsolate(), "__enable_check_time__",
 				v8::NewStringType::kNormal).ToLocalChecked());
 			v8::ScriptOrigin origin_check_time_name(check_time_name);
 
-			if (!v8::Script::Compile(context, v8src, &origin_check_time_name).ToLocal(&compiled_script)) {
+			if (!CompileCode(context, parameter_.code_, origin_check_time_name, compiled_script)) {
 				error_desc_f = ReportException(isolate_, &try_catch);
 				break;
 			}
@@ -705,7 +894,7 @@ namespace bumo{
 		}
 		else if (jsvalue->IsString()) {
 			jsonvalue["type"] = "string";
-			jsonvalue["value"] = std::string(ToCString(v8::String::Utf8Value(jsvalue)));
+			jsonvalue["value"] = JsToString(jsvalue);
 		}
 		else {
 			jsonvalue["type"] = "bool";
@@ -806,6 +995,36 @@ namespace bumo{
 		return *value ? *value : "<string conversion failed>";
 	}
 
+	std::string V8Contract::JsToString(v8::Local<v8::Value> value) {
+		if (value.IsEmpty() || !value->IsString()) {
+			return ToCString(v8::String::Utf8Value(value));
+		}
+
+		v8::Local<v8::String> str = v8::Local<v8::String>::Cast(value);
+		std::string result;
+		int length = str->Utf8Length();
+		if (length > 0) {
+			result.resize(length);
+			str->WriteUtf8(&result[0], length, NULL, v8::String::NO_NULL_TERMINATION);
+		}
+
+		//the c string stopped at the first zero
+		size_t end = result.find('\0');
+		if (end != std::string::npos) {
+			result.resize(end);
+		}
+		return result;
+	}
+
+	bool V8Contract::JsToInt64(v8::Local<v8::Value> value, int64_t &num) {
+		//an int32 prints as its own digits, the string would parse back to it
+		if (value->IsInt32()) {
+			num = value->Int32Value();
+			return true;
+		}
+		return utils::String::SafeStoi64(JsToString(value), num);
+	}
+
 	void V8Contract::Include(const v8::FunctionCallbackInfo<v8::Value>& args) {
 		do {
 			if (args.Length() != 1) {
@@ -831,7 +1050,6 @@ namespace bumo{
 			v8::TryCatch try_catch(args.GetIsolate());
 			std::string js_file = find_source->second; //load_file(*str);
 
-			v8::Local<v8::String> source = v8::String::NewFromUtf8(args.GetIsolate(), js_file.c_str());
 			v8::Local<v8::Script> script;
 
 			v8::Local<v8::String> check_time_name(
@@ -839,7 +1057,7 @@ namespace bumo{
 				v8::NewStringType::kNormal).ToLocalChecked());
 			v8::ScriptOrigin origin_check_time_name(check_time_name);
 
-			if (!v8::Script::Compile(args.GetIsolate()->GetCurrentContext(), source, &origin_check_time_name).ToLocal(&script)) {
+			if (!CompileCode(args.GetIsolate()->GetCurrentContext(), js_file, origin_check_time_name, script)) {
 				ReportException(args.GetIsolate(), &try_catch);
 				break;
 			}
@@ -926,7 +1144,7 @@ namespace bumo{
 				break;
 			} 
 
-			std::string topic = ToCString(v8::String::Utf8Value(args[0]));
+			std::string topic = JsToString(args[0]);
 
 			v8::HandleScope scope(args.GetIsolate());
 			V8Contract *v8_contract = GetContractFrom(args.GetIsolate());
@@ -948,10 +1166,10 @@ namespace bumo{
 			for (int i = 1; i < args.Length(); i++) {
 				std::string data;
 				if (args[i]->IsString()) {
-					data = ToCString(v8::String::Utf8Value(args[i]));
+					data = JsToString(args[i]);
 				}
 				else {
-					data = ToCString(v8::String::Utf8Value(args[i]->ToString()));
+					data = JsToString(args[i]->ToString());
 				}
 				*ope->mutable_log()->add_datas() = data;
 			}
@@ -986,7 +1204,7 @@ namespace bumo{
 				LOG_TRACE("contract execute error,CallBackGetAccountAsset, parameter 1 should be a String");
 				break;
 			}
-			std::string address = ToCString(v8::String::Utf8Value(args[0]));
+			std::string address = JsToString(args[0]);
 
 			if (!args[1]->IsObject()) {
 				LOG_TRACE("contract execute error,CallBackGetAccountAsset parameter 2 should be a object");
@@ -997,8 +1215,8 @@ namespace bumo{
 			v8::Local<v8::Object> v8_asset_property = args[1]->ToObject();
 			v8::Local<v8::Value> v8_issue = v8_asset_property->Get(v8::String::NewFromUtf8(args.GetIsolate(), "issuer"));
 			v8::Local<v8::Value> v8_code = v8_asset_property->Get(v8::String::NewFromUtf8(args.GetIsolate(), "code"));
-			asset_key.set_issuer(ToCString(v8::String::Utf8Value(v8_issue)));
-			asset_key.set_code(ToCString(v8::String::Utf8Value(v8_code)));
+			asset_key.set_issuer(JsToString(v8_issue));
+			asset_key.set_code(JsToString(v8_code));
 
 			bumo::AccountFrm::pointer account_frm = nullptr;
 			V8Contract *v8_contract = GetContractFrom(args.GetIsolate());
@@ -1016,7 +1234,7 @@ namespace bumo{
 			}
 
 			if (!getAccountSucceed) {
-				if (!Environment::AccountFromDB(address, account_frm)) {
+				if (!environment->GetFromDB(address, account_frm)) {
 					LOG_TRACE("not found account");
 					break;
 				}
@@ -1061,8 +1279,8 @@ namespace bumo{
 				break;
 			}
 
-			std::string address = ToCString(v8::String::Utf8Value(args[0]));
-			std::string input = ToCString(v8::String::Utf8Value(args[1]));
+			std::string address = JsToString(args[0]);
+			std::string input = JsToString(args[1]);
 
 			bumo::AccountFrm::pointer account_frm = nullptr;
 			V8Contract *v8_contract = GetContractFrom(args.GetIsolate());
@@ -1075,7 +1293,7 @@ namespace bumo{
 				break;
 			}
 			else {
-				if (!Environment::AccountFromDB(address, account_frm)) {
+				if (!environment->GetFromDB(address, account_frm)) {
 					LOG_TRACE("not found account");
 					break;
 				}
@@ -1248,7 +1466,7 @@ namespace bumo{
 
 			std::string input;
 			if (args.Length() > 2) {
-				input = ToCString(v8::String::Utf8Value(args[2]));
+				input = JsToString(args[2]);
 			}
 
 			V8Contract *v8_contract = GetContractFrom(args.GetIsolate());
@@ -1266,8 +1484,8 @@ namespace bumo{
 
 			std::string contractor = v8_contract->parameter_.this_address_;
 
-			std::string dest_address = std::string(ToCString(v8::String::Utf8Value(args[0])));
-			std::string arg_1 = std::string(ToCString(v8::String::Utf8Value(args[1])));
+			std::string dest_address = JsToString(args[0]);
+			std::string arg_1 = JsToString(args[1]);
 			int64_t pay_amount = 0;
 			if (!utils::String::SafeStoi64(arg_1, pay_amount) || pay_amount < 0){
 				error_desc = utils::String::Format("Contract paycoin error, dest_address:%s, amount:%s.", dest_address.c_str(), arg_1.c_str());
@@ -1336,8 +1554,8 @@ namespace bumo{
 
 			std::string contractor = v8_contract->parameter_.this_address_;
 
-			std::string assetCode = std::string(ToCString(v8::String::Utf8Value(args[0])));
-			std::string amount = std::string(ToCString(v8::String::Utf8Value(args[1])));
+			std::string assetCode = JsToString(args[0]);
+			std::string amount = JsToString(args[1]);
 			int64_t issueAmount = 0;
 			if (!utils::String::SafeStoi64(amount, issueAmount) || issueAmount < 0){
 				error_desc = utils::String::Format("Contract issueAsset error, asset code:%s, asset amount:%s.", assetCode.c_str(), amount.c_str());
@@ -1402,7 +1620,7 @@ namespace bumo{
 
 			std::string input;
 			if (args.Length() > 4) {
-				input = ToCString(v8::String::Utf8Value(args[4]));
+				input = JsToString(args[4]);
 			}
 
 			V8Contract *v8_contract = GetContractFrom(args.GetIsolate());
@@ -1420,10 +1638,10 @@ namespace bumo{
 
 			std::string contractor = v8_contract->parameter_.this_address_;
 
-			std::string dest_address = std::string(ToCString(v8::String::Utf8Value(args[0])));
-			std::string issuer    = std::string(ToCString(v8::String::Utf8Value(args[1])));
-			std::string assetCode = std::string(ToCString(v8::String::Utf8Value(args[2])));
-			std::string amount    = std::string(ToCString(v8::String::Utf8Value(args[3])));
+			std::string dest_address = JsToString(args[0]);
+			std::string issuer    = JsToString(args[1]);
+			std::string assetCode = JsToString(args[2]);
+			std::string amount    = JsToString(args[3]);
 			int64_t pay_amount = 0;
 			if (!utils::String::SafeStoi64(amount, pay_amount) || pay_amount < 0){
 				error_desc = utils::String::Format("Contract payAsset error, dest_address:%s, amount:%s.", dest_address.c_str(), amount.c_str());
@@ -1479,12 +1697,12 @@ namespace bumo{
 			LedgerContext *ledger_context = v8_contract->GetParameter().ledger_context_;
 			ledger_context->GetBottomTx()->ContractStepInc(100);
 
-			std::string address = ToCString(v8::String::Utf8Value(args[0]));
+			std::string address = JsToString(args[0]);
 			AccountFrm::pointer account_frm = NULL;
 
 			std::shared_ptr<Environment> environment = ledger_context->GetTopTx()->environment_;
 			if (!environment->GetEntry(address, account_frm)) {
-				Environment::AccountFromDB(address, account_frm);
+				environment->GetFromDB(address, account_frm);
 			}
 
 			std::string balance = "0";
@@ -1520,7 +1738,7 @@ namespace bumo{
 			LedgerContext *ledger_context = v8_contract->GetParameter().ledger_context_;
 			ledger_context->GetBottomTx()->ContractStepInc(100);
 
-			protocol::LedgerHeader lcl = LedgerManager::Instance().GetLastClosedLedger();
+			protocol::LedgerHeader lcl = ledger_context->GetLastClosedLedger();
 			int64_t seq = lcl.seq() - (int64_t)args[0]->NumberValue();
 			if (seq <= lcl.seq() - 1024 || seq > lcl.seq()) {
 				LOG_TRACE("The parameter seq(" FMT_I64 ") <= " FMT_I64 " or > " FMT_I64, seq, lcl.seq() - 1024, lcl.seq());
@@ -1589,10 +1807,10 @@ namespace bumo{
 			}
 
 			std::string contractor = v8_contract->parameter_.this_address_;
-			std::string  key = ToCString(v8::String::Utf8Value(args[0]));
+			std::string  key = JsToString(args[0]);
 			std::string  value = "";
 			if (!is_del){
-				value = ToCString(v8::String::Utf8Value(args[1]));
+				value = JsToString(args[1]);
 			}
 			if (key.empty()) {
 				error_desc = "Key is empty";
@@ -1646,11 +1864,11 @@ namespace bumo{
 			LedgerContext *ledger_context = v8_contract->GetParameter().ledger_context_;
 			ledger_context->GetTopTx()->ContractStepInc(100);
 
-			std::string key = ToCString(v8::String::Utf8Value(args[0]));
+			std::string key = JsToString(args[0]);
 			bumo::AccountFrm::pointer account_frm = nullptr;
 			std::shared_ptr<Environment> environment = ledger_context->GetTopTx()->environment_;
 			if (!environment->GetEntry(v8_contract->parameter_.this_address_, account_frm)) {
-				if (!Environment::AccountFromDB(v8_contract->parameter_.this_address_, account_frm)) {
+				if (!environment->GetFromDB(v8_contract->parameter_.this_address_, account_frm)) {
 					LOG_ERROR("not found account");
 					break;
 				}
@@ -1682,7 +1900,7 @@ namespace bumo{
 				break;
 			}
 
-			std::string arg0 = ToCString(v8::String::Utf8Value(args[0]));
+			std::string arg0 = JsToString(args[0]);
 
 			int64_t iarg0 = 0;
 			if (!utils::String::SafeStoi64(arg0, iarg0)){
@@ -1715,17 +1933,15 @@ namespace bumo{
 				break;
 			}
 
-			std::string arg0 = ToCString(v8::String::Utf8Value(args[0]));
-			std::string arg1 = ToCString(v8::String::Utf8Value(args[1]));
 			int64_t iarg0 = 0;
 			int64_t iarg1 = 0;
 
-			if (!utils::String::SafeStoi64(arg0, iarg0)){
+			if (!JsToInt64(args[0], iarg0)){
 				error_desc = "Contract execute error, int64Add, parameter 0 illegal, maybe exceed the limit value of int64.";
 				break;
 			}
 
-			if (!utils::String::SafeStoi64(arg1, iarg1)){
+			if (!JsToInt64(args[1], iarg1)){
 				error_desc = "Contract execute error, int64Add, parameter 1 illegal, maybe exceed the limit value of int64.";
 				break;
 			}
@@ -1764,17 +1980,15 @@ namespace bumo{
 				break;
 			}
 
-			std::string arg0 = ToCString(v8::String::Utf8Value(args[0]));
-			std::string arg1 = ToCString(v8::String::Utf8Value(args[1]));
 			int64_t iarg0 = 0;
 			int64_t iarg1 = 0;
 
-			if (!utils::String::SafeStoi64(arg0, iarg0)){
+			if (!JsToInt64(args[0], iarg0)){
 				error_desc = "Contract execute error, int64Sub, parameter 0 illegal, maybe exceed the limit value of int64.";
 				break;
 			}
 
-			if (!utils::String::SafeStoi64(arg1, iarg1)){
+			if (!JsToInt64(args[1], iarg1)){
 				error_desc = "Contract execute error, int64Sub, parameter 1 illegal, maybe exceed the limit value of int64.";
 				break;
 			}
@@ -1813,17 +2027,15 @@ namespace bumo{
 				break;
 			}
 
-			std::string arg0 = ToCString(v8::String::Utf8Value(args[0]));
-			std::string arg1 = ToCString(v8::String::Utf8Value(args[1]));
 			int64_t iarg0 = 0;
 			int64_t iarg1 = 0;
 
-			if (!utils::String::SafeStoi64(arg0, iarg0)){
+			if (!JsToInt64(args[0], iarg0)){
 				error_desc = "Contract execute error, int64Compare, parameter 0 illegal, maybe exceed the limit value of int64.";
 				break;
 			}
 
-			if (!utils::String::SafeStoi64(arg1, iarg1)){
+			if (!JsToInt64(args[1], iarg1)){
 				error_desc = "Contract execute error, int64Compare, parameter 1 illegal, maybe exceed the limit value of int64.";
 				break;
 			}
@@ -1863,17 +2075,15 @@ namespace bumo{
 				break;
 			}
 
-			std::string arg0 = ToCString(v8::String::Utf8Value(args[0]));
-			std::string arg1 = ToCString(v8::String::Utf8Value(args[1]));
 			int64_t iarg0 = 0;
 			int64_t iarg1 = 0;
 
-			if (!utils::String::SafeStoi64(arg0, iarg0)){
+			if (!JsToInt64(args[0], iarg0)){
 				error_desc = "Contract execute error, int64Div, parameter 0 illegal, maybe exceed the limit value of int64.";
 				break;
 			}
 
-			if (!utils::String::SafeStoi64(arg1, iarg1)){
+			if (!JsToInt64(args[1], iarg1)){
 				error_desc = "Contract execute error, int64Div, parameter 1 illegal, maybe exceed the limit value of int64.";
 				break;
 			}
@@ -1911,17 +2121,15 @@ namespace bumo{
 				break;
 			}
 
-			std::string arg0 = ToCString(v8::String::Utf8Value(args[0]));
-			std::string arg1 = ToCString(v8::String::Utf8Value(args[1]));
 			int64_t iarg0 = 0;
 			int64_t iarg1 = 0;
 
-			if (!utils::String::SafeStoi64(arg0, iarg0)){
+			if (!JsToInt64(args[0], iarg0)){
 				error_desc = "Contract execute error, int64Mod, parameter 0 illegal, maybe exceed the limit value of int64.";
 				break;
 			}
 
-			if (!utils::String::SafeStoi64(arg1, iarg1)){
+			if (!JsToInt64(args[1], iarg1)){
 				error_desc = "Contract execute error, int64Mod, parameter 1 illegal, maybe exceed the limit value of int64.";
 				break;
 			}
@@ -1960,17 +2168,15 @@ namespace bumo{
 				break;
 			}
 
-			std::string arg0 = ToCString(v8::String::Utf8Value(args[0]));
-			std::string arg1 = ToCString(v8::String::Utf8Value(args[1]));
 			int64_t iarg0 = 0;
 			int64_t iarg1 = 0;
 
-			if (!utils::String::SafeStoi64(arg0, iarg0)){
+			if (!JsToInt64(args[0], iarg0)){
 				error_desc = "Contract execute error, int64Mul, parameter 0 illegal, maybe exceed the limit value of int64.";
 				break;
 			}
 
-			if (!utils::String::SafeStoi64(arg1, iarg1)){
+			if (!JsToInt64(args[1], iarg1)){
 				error_desc = "Contract execute error, int64Mul, parameter 1 illegal, maybe exceed the limit value of int64.";
 				break;
 			}
@@ -2004,7 +2210,7 @@ namespace bumo{
 				break;
 			}
 
-			std::string arg0 = ToCString(v8::String::Utf8Value(args[0]));
+			std::string arg0 = JsToString(args[0]);
 			if (!utils::String::IsDecNumber(arg0, General::BU_DECIMALS)) {
 				error_desc = utils::String::Format("Not decimal number:%s", arg0.c_str());
 				break;
@@ -2027,58 +2233,18 @@ namespace bumo{
 			v8::NewStringType::kNormal).ToLocalChecked());
 	}
 
-	QueryContract::QueryContract():contract_(NULL){}
-	QueryContract::~QueryContract() {
-	}
-	bool QueryContract::Init(int32_t type, const ContractParameter &paramter) {
-		parameter_ = paramter;
-		if (type == Contract::TYPE_V8) {
-			
-		}
-		else {
-			std::string error_msg = utils::String::Format("Contract type(%d) not support", type);
-			LOG_ERROR("%s", error_msg.c_str());
-			return false;
-		}
-		return true;
-	}
-
-	void QueryContract::Cancel() {
-		utils::MutexGuard guard(mutex_);
-		if (contract_) {
-			contract_->Cancel();
-		} 
-	}
-
-	bool QueryContract::GetResult(Json::Value &result) {
-		result = result_;
-		return ret_;
-	}
-
-	void QueryContract::Run() {
-		do {
-			utils::MutexGuard guard(mutex_);
-			contract_ = new V8Contract(true, parameter_);
-		} while (false);
-
-		ret_ = contract_->Query(result_);
-
-		do {
-			utils::MutexGuard guard(mutex_);
-			delete contract_;
-			contract_ = NULL;
-		} while (false);
-	}
-
 	ContractManager::ContractManager() {}
 	ContractManager::~ContractManager() {}
 
 	bool ContractManager::Initialize(int argc, char** argv) {
+		code_cache_.Initialize(Configure::Instance().ledger_configure_.contract_code_cache_size_,
+			Configure::Instance().ledger_configure_.contract_code_cache_persist_);
 		V8Contract::Initialize(argc, argv);
 		return true;
 	}
 
 	bool ContractManager::Exit() {
+		V8Contract::DisposeIsolates();
 		return true;
 	}
 
@@ -2132,6 +2298,7 @@ namespace bumo{
 			ledger_context->PushLog(contract->GetParameter().this_address_, contract->GetLogs());
 			do {
 				//delete the contract from map
+				utils::MutexGuard guard(contracts_lock_);
 				contracts_.erase(contract->GetId());
 				delete contract;
 			} while (false);
@@ -2164,6 +2331,7 @@ namespace bumo{
 			ledger_context->PushRet(contract->GetParameter().this_address_, result);
 			do {
 				//delete the contract from map
+				utils::MutexGuard guard(contracts_lock_);
 				contracts_.erase(contract->GetId());
 				delete contract;
 			} while (false);
@@ -2174,19 +2342,12 @@ namespace bumo{
 	}
 
 	bool ContractManager::Cancel(int64_t contract_id) {
-		//another thread cancel the vm
-		Contract *contract = NULL;
-		do {
-			utils::MutexGuard guard(contracts_lock_);
-			ContractMap::iterator iter = contracts_.find(contract_id);
-			if (iter!= contracts_.end()) {
-				contract = iter->second;
-			} 
-		} while (false);
-
-		if (contract){
-			contract->Cancel();
-		} 
+		//another thread cancel the vm, under the lock so the contract is not deleted meanwhile
+		utils::MutexGuard guard(contracts_lock_);
+		ContractMap::iterator iter = contracts_.find(contract_id);
+		if (iter != contracts_.end()) {
+			iter->second->Cancel();
+		}
 
 		return true;
 	}
@@ -16,6 +16,7 @@
 #ifndef CONTRACT_MANAGER_H_
 #define CONTRACT_MANAGER_H_
 #include <map>
+#include <list>
 #include <unordered_map>
 #include <string>
 
@@ -25,6 +26,7 @@
 #include <libplatform/libplatform-export.h>
 #include <proto/cpp/chain.pb.h>
 #include "ledgercontext_manager.h"
+#include "contract_code_cache.h"
 
 namespace bumo{
 
@@ -118,6 +120,7 @@ namespace bumo{
 	class V8Contract : public Contract {
 		v8::Isolate* isolate_;
 		v8::Global<v8::Context> g_context_;
+		bool terminated_;
 	public:
 		V8Contract(bool readonly, const ContractParameter &parameter);
 		virtual ~V8Contract();
@@ -156,11 +159,41 @@ namespace bumo{
 		static v8::Platform* 	platform_;
 		static v8::Isolate::CreateParams create_params_;
 
+		//idle isolates of each thread, every call runs in a new context so nothing of a call is seen by the next one.
+		//an isolate is only taken again by the thread that released it
+		static utils::Mutex isolate_pool_mutex_;
+		static std::map<size_t, std::list<v8::Isolate*>> isolate_pools_;
+		static const size_t isolate_pool_max_ = 4;
+		//used heap of a new isolate, a released isolate above it is disposed
+		static int64_t isolate_heap_size_;
+		static v8::Isolate *AcquireIsolate();
+		static void ReleaseIsolate(v8::Isolate *isolate, bool reusable);
+		static void DisposeIsolates();
+
+		//contexts built once at startup, a new context is deserialized instead of built for every call
+		enum SNAPSHOT_CONTEXT {
+			SNAPSHOT_WRITE = 0,
+			SNAPSHOT_READONLY = 1,
+			SNAPSHOT_JSLINT = 2
+		};
+		static v8::StartupData snapshot_blob_;
+		static std::vector<intptr_t> external_references_;
+		static bool jslint_snapshot_;
+		static bool CreateSnapshot();
+		//a context of the contract with the random sources removed, empty on error
+		static v8::Local<v8::Context> CreateSandboxContext(v8::Isolate* isolate, bool readonly, Json::Value &error_msg);
+		//compile through the code cache of the contract manager
+		static bool CompileCode(v8::Local<v8::Context> context, const std::string &code, const v8::ScriptOrigin &origin, v8::Local<v8::Script> &script);
+
 		static bool RemoveRandom(v8::Isolate* isolate, Json::Value &error_msg);
 		static v8::Local<v8::Context> CreateContext(v8::Isolate* isolate, bool readonly);
 		static V8Contract *GetContractFrom(v8::Isolate* isolate);
 		static Json::Value ReportException(v8::Isolate* isolate, v8::TryCatch* try_catch);
 		static const char* ToCString(const v8::String::Utf8Value& value);
+		//the same string as ToCString(Utf8Value(value)), a js string is written straight into the result
+		static std::string JsToString(v8::Local<v8::Value> value);
+		//the same as SafeStoi64 on the string of the value, an int32 is taken as it is
+		static bool JsToInt64(v8::Local<v8::Value> value, int64_t &num);
 		static void CallBackLog(const v8::FunctionCallbackInfo<v8::Value>& args);
 		static void CallBackTopicLog(const v8::FunctionCallbackInfo<v8::Value>& args);
 		static void CallBackGetAccountAsset(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -224,22 +257,6 @@ namespace bumo{
         bool ExecuteCode(const char* fname);
 	};
 
-	class QueryContract : public utils::Thread{
-		Contract *contract_;
-		ContractParameter parameter_;
-		Json::Value result_;
-		bool ret_;
-		utils::Mutex mutex_;
-	public:
-		QueryContract();
-		~QueryContract();
-
-		bool Init(int32_t type, const ContractParameter &paramter);
-		virtual void Run();
-		void Cancel();
-		bool GetResult(Json::Value &result);
-	};
-
 // 	class TestContract : public utils::Thread {
 // 		int32_t type_;
 // 		ContractTestParameter parameter_;
@@ -265,6 +282,8 @@ namespace bumo{
 		utils::Mutex contracts_lock_;
 		ContractMap contracts_;
 	public:
+		ContractCodeCache code_cache_;
+
 		ContractManager();
 		~ContractManager();
 
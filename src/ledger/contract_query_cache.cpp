@@ -0,0 +1,44 @@
+/*
+	bumo is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	bumo is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with bumo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <common/general.h>
+#include "contract_query_cache.h"
+
+namespace bumo {
+	std::string ContractQueryCache::GetKey(const std::string &address, const std::string &input) {
+		return address + "-" + HashWrapper::Crypto(input);
+	}
+
+	bool ContractQueryCache::Get(const std::string &key, int64_t version, Json::Value &result) {
+		std::shared_ptr<const Json::Value> value;
+		if (!utils::CountedLruCache<std::string, std::shared_ptr<const Json::Value>>::Get(key, version, value)) {
+			return false;
+		}
+
+		//copy out of the lock, the entry is never changed
+		result = *value;
+		return true;
+	}
+
+	void ContractQueryCache::Set(const std::string &key, int64_t version, const Json::Value &result) {
+		//a ledger closed while the query ran, the result may be of either ledger
+		utils::CountedLruCache<std::string, std::shared_ptr<const Json::Value>>::Set(key, version, std::make_shared<Json::Value>(result));
+	}
+
+	void ContractQueryCache::GetModuleStatus(Json::Value &data) {
+		utils::CountedLruCache<std::string, std::shared_ptr<const Json::Value>>::GetModuleStatus(data);
+		data["version"] = GetVersion();
+	}
+}
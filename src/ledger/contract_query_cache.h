@@ -0,0 +1,40 @@
+/*
+	bumo is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	bumo is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with bumo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CONTRACT_QUERY_CACHE_H_
+#define CONTRACT_QUERY_CACHE_H_
+
+#include <utils/counted_lru_cache.h>
+#include <json/json.h>
+
+namespace bumo {
+
+	//results of the contract queries on the last closed ledger, the wallets query the
+	//same contracts with the same input again and again between two ledgers.
+	//the version is the sequence of the last closed ledger, closing a ledger drops all
+	//the results, and a result of a query running while a ledger closed is not cached
+	class ContractQueryCache : public utils::CountedLruCache<std::string, std::shared_ptr<const Json::Value>> {
+	public:
+		static std::string GetKey(const std::string &address, const std::string &input);
+
+		//take the version before running the query, and set the result with it
+		bool Get(const std::string &key, int64_t version, Json::Value &result);
+		void Set(const std::string &key, int64_t version, const Json::Value &result);
+
+		void GetModuleStatus(Json::Value &data);
+	};
+}
+
+#endif
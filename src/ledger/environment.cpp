@@ -15,6 +15,7 @@
 
 #include <common/storage.h>
 #include "ledger_manager.h"
+#include "state_view.h"
 #include "environment.h"
 
 namespace bumo{
@@ -28,6 +29,7 @@ namespace bumo{
 
 	Environment::Environment(Environment* parent){
 
+		state_view_ = parent ? parent->state_view_ : nullptr;
 		useAtomMap_ = Configure::Instance().ledger_configure_.use_atom_map_;
 		if (useAtomMap_)
 		{
@@ -49,7 +51,7 @@ namespace bumo{
 			return Get(key, frm);
 
 		if (entries_.find(key) == entries_.end()){
-			if (AccountFromDB(key, frm)){
+			if (GetFromDB(key, frm)){
 				entries_[key] = frm;
 				return true;
 			}
@@ -91,12 +93,23 @@ namespace bumo{
 
 	bool Environment::GetFromDB(const std::string &address, AccountFrm::pointer &account_ptr)
 	{
+		if (state_view_){
+			return state_view_->AccountFromDB(address, account_ptr);
+		}
 		return AccountFromDB(address, account_ptr);
 	}
 
 	bool Environment::AccountFromDB(const std::string &address, AccountFrm::pointer &account_ptr){
 
-		auto db = Storage::Instance().account_db();
+		AccountCache &cache = LedgerManager::Instance().account_cache_;
+		int64_t version = cache.GetVersion();
+		AccountCache::pointer cached = nullptr;
+		if (cache.Get(address, version, cached)){
+			//the callers change the account, give them a copy
+			account_ptr = std::make_shared<AccountFrm>(*cached);
+			return true;
+		}
+
 		std::string index = DecodeAddress(address);
 		std::string buff;
 		if (!LedgerManager::Instance().tree_->Get(index, buff)){
@@ -107,6 +120,7 @@ namespace bumo{
 		if (!account.ParseFromString(buff)){
 			PROCESS_EXIT("fatal error, account(%s) ParseFromString failed", address.c_str());
 		}
+		cache.Set(address, version, account);
 		account_ptr = std::make_shared<AccountFrm>(account);
 		return true;
 
@@ -117,6 +131,7 @@ namespace bumo{
 		mapKV& data	= GetActionBuf();
 		settingKV& settings = settings_.GetActionBuf();
 		std::shared_ptr<Environment> next = std::make_shared<Environment>(&data, &settings);
+		next->state_view_ = state_view_;
 
 		return next;
 	}
@@ -25,6 +25,8 @@
 #include "account.h"
 
 namespace bumo {
+	class StateView;
+
 	class Environment : public AtomMap<std::string, AccountFrm>{
 	public:
 		typedef AtomMap<std::string, Json::Value>::mapKV settingKV;
@@ -36,6 +38,8 @@ namespace bumo {
 
 		Environment *parent_;
 		bool useAtomMap_;
+		//the accounts are read from the view instead of the live tree when it is set
+		std::shared_ptr<StateView> state_view_;
 
 		Environment() = default;
 		Environment(Environment const&) = delete;
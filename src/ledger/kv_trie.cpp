@@ -17,7 +17,7 @@
 
 namespace bumo{
 
-	KVTrie::KVTrie(){
+	KVTrie::KVTrie() :node_cache_(nullptr), time_(0){
 		//leafcount_ = 0;
 	}
 
@@ -35,13 +35,31 @@ namespace bumo{
 		root_ = std::make_shared< NodeFrm>(location);
 
 		protocol::Node info;
-		if (storage_load(location, info)){
+		if (storage_load(location, "", info)){
 			root_->info_.CopyFrom(info);
 			Load(root_, depth);
 		}
 		return true;
 	}
 
+	bool KVTrie::Init(bumo::KeyValueDb* db, std::shared_ptr<WRITE_BATCH> batch, const std::string& prefix, const HASH& root_hash, TrieNodeCache* node_cache,
+		KeyValueDbSnapshot::pointer snapshot){
+		mdb_ = db;
+		prefix_ = prefix;
+		batch_ = batch;
+		node_cache_ = node_cache;
+		snapshot_ = snapshot;
+		Location location;
+		location.push_back(0);
+		root_ = std::make_shared< NodeFrm>(location);
+
+		protocol::Node info;
+		if (storage_load(location, root_hash, info)){
+			root_->info_.CopyFrom(info);
+		}
+		return true;
+	}
+
 	void KVTrie::Load(NodeFrm::POINTER node, int depth){
 		if (depth < 0){
 			return;
@@ -65,7 +83,7 @@ namespace bumo{
 	}
 
 	void KVTrie::StorageSaveNode(NodeFrm::POINTER node) {
-		std::string buff = node->info_.SerializeAsString();
+		std::string buff = EncodeNode(node->location_, node->info_);
 		std::string key = Location2DBkey(node->location_, false);
 		batch_->Put(key, buff);
 		//LOG_DEBUG("save INNER(%s)", utils::String::BinToHexString(key).c_str());
@@ -77,18 +95,31 @@ namespace bumo{
 		//LOG_DEBUG("save LEAF(%s)", utils::String::BinToHexString(key).c_str());
 	}
 
-	bool KVTrie::storage_load(const Location& location, protocol::Node& info)  {
+	bool KVTrie::storage_load(const Location& location, const HASH& hash, protocol::Node& info)  {
 		int64_t t1 = utils::Timestamp::HighResolution();
 		std::string key = Location2DBkey(location, false);
 		std::string buff;
+
+		bool cacheable = node_cache_ != nullptr && !hash.empty();
+		std::string cache_key = key + hash;
+		if (cacheable && node_cache_->Get(cache_key, buff)){
+			return DecodeNode(location, buff, info);
+		}
+
 		//LOG_DEBUG("LOAD INNER:%s", utils::String::BinToHexString(key).c_str());
-		int32_t stat = mdb_->Get(key, buff);
+		int32_t stat = StorageGet(key, buff);
 		int64_t t2 = utils::Timestamp::HighResolution();
 
 		time_ += (t2 - t1);
 
 		if (stat == 1){
-			info.ParseFromString(buff);
+			if (!DecodeNode(location, buff, info)){
+				PROCESS_EXIT("decode node(%s) failed", utils::String::BinToHexString(key).c_str());
+			}
+			//the db may hold a newer node at this location, keep only the expected one
+			if (cacheable && HashCrypto(info.SerializeAsString()) == hash){
+				node_cache_->Set(cache_key, buff);
+			}
 			return true;
 		}
 		else if (stat == 0)
@@ -113,7 +144,7 @@ namespace bumo{
 	bool KVTrie::StorageGetLeaf(const Location& location, std::string& value) {
 		std::string key = Location2DBkey(location, true);
 		//LOG_DEBUG("GET LEAF %s", utils::String::BinToHexString(key).c_str());
-		int32_t stat = mdb_->Get(key, value);
+		int32_t stat = StorageGet(key, value);
 		if (stat == 1){
 			return true;
 		}
@@ -129,6 +160,13 @@ namespace bumo{
 		return HashWrapper::Crypto(input);
 	}
 
+	int32_t KVTrie::StorageGet(const std::string& key, std::string& value){
+		if (snapshot_ != nullptr){
+			return snapshot_->Get(key, value);
+		}
+		return mdb_->Get(key, value);
+	}
+
 	std::string KVTrie::Location2DBkey(const Location& location, bool leaf){
 		std::string key = location;
 		if (leaf){
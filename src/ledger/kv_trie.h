@@ -16,14 +16,21 @@
 #ifndef KV_TRIE_H_
 #define KV_TRIE_H_
 
+#include <utils/counted_lru_cache.h>
 #include <common/storage.h>
 #include "trie.h"
 
 namespace bumo{
 
+	//inner nodes shared by the tries of all accounts. a node is keyed by its
+	//db key and its hash, so an entry never goes stale when the node is rewritten
+	typedef utils::CountedLruCache<std::string, std::string> TrieNodeCache;
+
 	class KVTrie :public Trie{
 		KeyValueDb* mdb_;
 		std::string prefix_;
+		TrieNodeCache* node_cache_;
+		KeyValueDbSnapshot::pointer snapshot_;
 	public:
 		std::shared_ptr<WRITE_BATCH> batch_;
 		int64_t time_;
@@ -32,11 +39,17 @@ namespace bumo{
 		~KVTrie();
 		bool Init(bumo::KeyValueDb* db, std::shared_ptr<WRITE_BATCH>, const std::string& prefix, int depth);
 
+		//load only the root, other nodes are loaded through the cache when walked.
+		//reads go to the snapshot if it is not null
+		bool Init(bumo::KeyValueDb* db, std::shared_ptr<WRITE_BATCH>, const std::string& prefix, const HASH& root_hash, TrieNodeCache* node_cache,
+			KeyValueDbSnapshot::pointer snapshot);
+
 		//int LeafCount();
 		bool AddToDB();
 	private:
 		void Load(NodeFrm::POINTER node, int depth);
 	    std::string Location2DBkey(const Location& location, bool leaf);
+		int32_t StorageGet(const std::string& key, std::string& value);
 	protected:
 		virtual void StorageSaveNode(NodeFrm::POINTER node) override;
 		virtual void StorageSaveLeaf(NodeFrm::POINTER node) override;
@@ -44,7 +57,7 @@ namespace bumo{
 		virtual void StorageDeleteNode(NodeFrm::POINTER node) override;
 		virtual void StorageDeleteLeaf(NodeFrm::POINTER node) override;
 
-		virtual bool storage_load(const Location& location, protocol::Node& info) override;
+		virtual bool storage_load(const Location& location, const HASH& hash, protocol::Node& info) override;
 		virtual bool StorageGetLeaf(const Location& location, std::string& value)override;
 		virtual std::string HashCrypto(const std::string& input) override;
 	};
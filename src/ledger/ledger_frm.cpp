@@ -23,6 +23,7 @@
 #include "ledger_frm.h"
 #include "ledgercontext_manager.h"
 #include "contract_manager.h"
+#include "parallel_executor.h"
 
 namespace bumo {
 
@@ -30,7 +31,8 @@ namespace bumo {
 
 	ProposeTxsResult::ProposeTxsResult() :
 		block_timeout_(false),
-		exec_result_(false) {}
+		exec_result_(false),
+		sealed_count_(-1) {}
 
 	ProposeTxsResult::~ProposeTxsResult() {}
 
@@ -38,6 +40,7 @@ namespace bumo {
 		exec_result_ = result.exec_result_;
 		cons_validation_ = result.cons_validation_;
 		need_dropped_tx_ = result.need_dropped_tx_;
+		sealed_count_ = result.sealed_count_;
 	}
 
 	LedgerFrm::LedgerFrm() {
@@ -71,6 +74,15 @@ namespace bumo {
 
 	bool LedgerFrm::AddToDb(WRITE_BATCH &batch) {
 		KeyValueDb *db = Storage::Instance().ledger_db();
+		AddToBatch(batch);
+		if (!db->WriteBatch(batch)){
+			PROCESS_EXIT("Write ledger and transaction failed(%s)", db->error_desc().c_str());
+		}
+		return true;
+	}
+
+	void LedgerFrm::AddToBatch(WRITE_BATCH &batch) {
+		KeyValueDb *db = Storage::Instance().ledger_db();
 
 		batch.Put(bumo::General::KEY_LEDGER_SEQ, utils::String::ToString(ledger_.header().seq()));
 		batch.Put(ComposePrefix(General::LEDGER_PREFIX, ledger_.header().seq()), ledger_.header().SerializeAsString());
@@ -147,11 +159,6 @@ namespace bumo {
 
 			batch.Put(General::LAST_TX_HASHS, new_last_hashs.SerializeAsString());
 		}
-
-		if (!db->WriteBatch(batch)){
-			PROCESS_EXIT("Write ledger and transaction failed(%s)", db->error_desc().c_str());
-		}
-		return true;
 	}
 
 	bool LedgerFrm::Cancel() {
@@ -221,6 +228,29 @@ namespace bumo {
 		}
 	}
 
+	void LedgerFrm::InitTransactions(const protocol::TransactionEnvSet &txset, std::vector<TransactionFrm::pointer> &tx_frms) {
+		utils::ThreadPool &pool = LedgerManager::Instance().worker_pool_;
+		size_t total = txset.txs_size();
+		tx_frms.resize(total);
+
+		//one job per slice, the signatures of a slice are verified as one group
+		size_t slice = total / (pool.Size() + 1) + 1;
+		std::vector<utils::ThreadCallback> jobs;
+		for (size_t begin = 0; begin < total; begin += slice) {
+			size_t end = MIN(begin + slice, total);
+			jobs.push_back([&txset, &tx_frms, begin, end]() {
+				std::vector<TransactionFrm *> slice_frms;
+				for (size_t i = begin; i < end; i++) {
+					tx_frms[i] = std::make_shared<TransactionFrm>(txset.txs(i), false);
+					slice_frms.push_back(tx_frms[i].get());
+				}
+				TransactionFrm::VerifySignatures(slice_frms);
+			});
+		}
+
+		pool.Execute(jobs);
+	}
+
 	bool LedgerFrm::ApplyPropose(const protocol::ConsensusValue& request,
 		LedgerContext *ledger_context,
 		ProposeTxsResult &proposed_result) {
@@ -241,12 +271,32 @@ namespace bumo {
 			return false;
 		}
 
+		std::vector<TransactionFrm::pointer> tx_frms;
+		InitTransactions(request.txset(), tx_frms);
+
+		//the journal keeps the changes of the txs on top of the state before them
+		TransactionJournal &journal = LedgerManager::Instance().tx_journal_;
+		bool use_journal = environment_->useAtomMap_ && !IsTestMode() && journal.Enabled();
+		std::string journal_key = TransactionJournal::BaseKey(request);
+
+		//the simple txs are run on the pool first when parallel execute is on
+		ParallelExecutor executor(this, environment_);
+		executor.Speculate(request, tx_frms, std::set<int32_t>());
+
 		for (int i = 0; i < request.txset().txs_size() && enabled_; i++) {
 			const protocol::TransactionEnv &txproto = request.txset().txs(i);
 
-			TransactionFrm::pointer tx_frm = std::make_shared<TransactionFrm>(txproto);
+			//seal the set at this prefix, the result applied so far is kept
+			if (!IsTestMode() && utils::Timestamp::HighResolution() - start_time > General::BLOCK_PROPOSE_TIME_BUDGET) {
+				LOG_INFO("Propose time budget is used up, seal the txset at %d of %d", i, request.txset().txs_size());
+				proposed_result.sealed_count_ = i;
+				break;
+			}
+
+			TransactionFrm::pointer tx_frm = tx_frms[i];
 
 			if (!tx_frm->ValidForApply(environment_, !IsTestMode())) {
+				executor.Skip(tx_frm);
 				dropped_tx_frms_.push_back(tx_frm);
 				proposed_result.need_dropped_tx_.insert(i); //for drop
 				continue;
@@ -254,6 +304,7 @@ namespace bumo {
 
 			//pay fee
 			if (!tx_frm->PayFee(environment_, total_fee_)) {
+				executor.Skip(tx_frm);
 				dropped_tx_frms_.push_back(tx_frm);
 				proposed_result.need_dropped_tx_.insert(i);//for drop
 				continue;
@@ -266,10 +317,21 @@ namespace bumo {
 			tx_frm->EnableChecked();
 			tx_frm->SetMaxEndTime(utils::Timestamp::HighResolution() + General::TX_EXECUTE_TIME_OUT);
 
-			bool ret = tx_frm->Apply(this, environment_);
+			bool ret = executor.Apply(i, tx_frm, nullptr);
 			//caculate byte fee ,do not store when fee not enough 
 			std::string error_info;
-			if (tx_frm->IsExpire(error_info)) {
+			bool expired = tx_frm->IsExpire(error_info);
+			if (use_journal) {
+				journal_key = TransactionJournal::NextKey(journal_key, tx_frm->GetFullHash(), expired);
+				//a cancelled run is not a result of the tx, so it is not replayed
+				if (!expired && !ledger_context->IsCancelled()) {
+					JournalEntry::pointer entry = std::make_shared<JournalEntry>();
+					tx_frm->ToJournal(*entry, ret);
+					journal.Set(journal_key, entry);
+				}
+			}
+
+			if (expired) {
 				LOG_ERROR("Transaction(%s) apply failed. %s, %s",
 					utils::String::BinToHexString(tx_frm->GetContentHash()).c_str(), tx_frm->GetResult().desc().c_str(),
 					error_info.c_str());
@@ -325,10 +387,22 @@ namespace bumo {
 			return false;
 		}
 
+		std::vector<TransactionFrm::pointer> tx_frms;
+		InitTransactions(request.txset(), tx_frms);
+
+		//the journal keeps the changes of the txs on top of the state before them
+		TransactionJournal &journal = LedgerManager::Instance().tx_journal_;
+		bool use_journal = environment_->useAtomMap_ && !IsTestMode() && journal.Enabled();
+		std::string journal_key = TransactionJournal::BaseKey(request);
+
+		//the simple txs are run on the pool first when parallel execute is on
+		ParallelExecutor executor(this, environment_);
+		executor.Speculate(request, tx_frms, std::set<int32_t>());
+
 		for (int i = 0; i < request.txset().txs_size() && enabled_; i++) {
-			auto txproto = request.txset().txs(i);
+			const protocol::TransactionEnv &txproto = request.txset().txs(i);
 
-			TransactionFrm::pointer tx_frm = std::make_shared<TransactionFrm>(txproto);
+			TransactionFrm::pointer tx_frm = tx_frms[i];
 
 			if (!tx_frm->ValidForApply(environment_, !IsTestMode())) {
 				LOG_ERROR("Check consensus value failed, valid for apply failed, seq(" FMT_I64 ")", request.ledger_seq());
@@ -348,10 +422,21 @@ namespace bumo {
 			tx_frm->EnableChecked();
 			tx_frm->SetMaxEndTime(utils::Timestamp::HighResolution() + General::TX_EXECUTE_TIME_OUT);
 
-			bool ret = tx_frm->Apply(this, environment_);
+			bool ret = executor.Apply(i, tx_frm, nullptr);
 			//caculate byte fee ,do not store when fee not enough 
 			std::string error_info;
-			if (tx_frm->IsExpire(error_info)) {
+			bool expired = tx_frm->IsExpire(error_info);
+			if (use_journal) {
+				journal_key = TransactionJournal::NextKey(journal_key, tx_frm->GetFullHash(), expired);
+				//a cancelled run is not a result of the tx, so it is not replayed
+				if (!expired && !ledger_context->IsCancelled()) {
+					JournalEntry::pointer entry = std::make_shared<JournalEntry>();
+					tx_frm->ToJournal(*entry, ret);
+					journal.Set(journal_key, entry);
+				}
+			}
+
+			if (expired) {
 				LOG_ERROR("Transaction(%s) apply failed. %s, %s",
 					utils::String::BinToHexString(tx_frm->GetContentHash()).c_str(), tx_frm->GetResult().desc().c_str(),
 					error_info.c_str());
@@ -410,19 +495,33 @@ namespace bumo {
 			return false;
 		}
 
+		std::vector<TransactionFrm::pointer> tx_frms;
+		InitTransactions(request.txset(), tx_frms);
+
+		//the journal keeps the changes of the txs on top of the state before them
+		TransactionJournal &journal = LedgerManager::Instance().tx_journal_;
+		bool use_journal = environment_->useAtomMap_ && !IsTestMode() && journal.Enabled();
+		std::string journal_key = TransactionJournal::BaseKey(request);
+
+		//the simple txs are run on the pool first when parallel execute is on
+		ParallelExecutor executor(this, environment_);
+		executor.Speculate(request, tx_frms, expire_txs_check);
+
 		for (int i = 0; i < request.txset().txs_size() && enabled_; i++) {
-			auto txproto = request.txset().txs(i);
-			
-			TransactionFrm::pointer tx_frm = std::make_shared<TransactionFrm>(txproto);
+			const protocol::TransactionEnv &txproto = request.txset().txs(i);
+
+			TransactionFrm::pointer tx_frm = tx_frms[i];
 
 			if (!tx_frm->ValidForApply(environment_,!IsTestMode())){
 				LOG_WARN("Should not go hear");
+				executor.Skip(tx_frm);
 				continue;
 			}
 
 			//pay fee
 			if (!tx_frm->PayFee(environment_, total_fee_)) {
 				LOG_WARN("Should not go hear");
+				executor.Skip(tx_frm);
 				continue;
 			}
 
@@ -431,12 +530,23 @@ namespace bumo {
 			if (environment_->useAtomMap_) environment_->Commit();
 
 
-			if ( expire_txs_check.find(i) != expire_txs_check.end()) {
+			bool expired = expire_txs_check.find(i) != expire_txs_check.end();
+			if (use_journal) {
+				journal_key = TransactionJournal::NextKey(journal_key, tx_frm->GetFullHash(), expired);
+			}
+
+			JournalEntry::pointer entry;
+			if (expired) {
 				// follow the consensus value and do not apply
 				tx_frm->ApplyExpireResult();
+				executor.Skip(tx_frm);
 			}
 			else {
-				bool ret = tx_frm->Apply(this, environment_);
+				//replay the changes recorded on the same state, the contracts are not run again
+				if (use_journal) {
+					journal.Get(journal_key, entry);
+				}
+				bool ret = executor.Apply(i, tx_frm, entry);
 				if (!ret) {
 					LOG_ERROR("transaction(%s) apply failed. %s",
 						utils::String::BinToHexString(tx_frm->GetContentHash()).c_str(), tx_frm->GetResult().desc().c_str());
@@ -484,38 +594,57 @@ namespace bumo {
 		return ledger_;
 	}
 
-	bool LedgerFrm::Commit(KVTrie* trie, int64_t& new_count, int64_t& change_count) {
-		auto batch = trie->batch_;
-
+	void LedgerFrm::GetChangedAccounts(std::vector<std::string> &addresses, std::vector<std::shared_ptr<AccountFrm>> &accounts) {
 		if (environment_->useAtomMap_)
 		{
-			auto entries = environment_->GetData();
+			const Environment::mapKV &entries = environment_->GetData();
 
 			for (auto it = entries.begin(); it != entries.end(); it++){
 
 				if (it->second.type_ == Environment::DEL)
 					continue; //there is no delete account function now, not yet
 
-				std::shared_ptr<AccountFrm> account = it->second.value_;
-				account->UpdateHash(batch);
-				std::string ss = account->Serializer();
-				std::string index = DecodeAddress(it->first);
-				bool is_new = trie->Set(index, ss);
-				if (is_new){
-					new_count++;
-				}
-				else{
-					change_count++;
-				}
+				addresses.push_back(it->first);
+				accounts.push_back(it->second.value_);
 			}
-			return true;
 		}
+		else{
+			for (auto it = environment_->entries_.begin(); it != environment_->entries_.end(); it++){
+				addresses.push_back(it->first);
+				accounts.push_back(it->second);
+			}
+		}
+	}
+
+	bool LedgerFrm::Commit(KVTrie* trie, int64_t& new_count, int64_t& change_count) {
+		auto batch = trie->batch_;
+
+		std::vector<std::string> addresses;
+		std::vector<std::shared_ptr<AccountFrm>> accounts;
+		GetChangedAccounts(addresses, accounts);
+
+		//the sub tries of the accounts are independent, hash them on the pool with a batch for each account
+		utils::ThreadPool &pool = LedgerManager::Instance().worker_pool_;
+		std::vector<std::shared_ptr<WRITE_BATCH>> account_batches(accounts.size());
+		size_t slice = accounts.size() / (pool.Size() * 4 + 1) + 1;
+		std::vector<utils::ThreadCallback> jobs;
+		for (size_t begin = 0; begin < accounts.size(); begin += slice){
+			size_t end = MIN(begin + slice, accounts.size());
+			jobs.push_back([&accounts, &account_batches, begin, end]() {
+				for (size_t i = begin; i < end; i++){
+					account_batches[i] = std::make_shared<WRITE_BATCH>();
+					accounts[i]->UpdateHash(account_batches[i]);
+				}
+			});
+		}
+		pool.Execute(jobs);
+
+		//merge in the account order, the same as hashing them one by one
+		for (size_t i = 0; i < accounts.size(); i++){
+			KeyValueDb::AppendBatch(*batch, *account_batches[i]);
 
-		for (auto it = environment_->entries_.begin(); it != environment_->entries_.end(); it++){
-			std::shared_ptr<AccountFrm> account = it->second;
-			account->UpdateHash(batch);
-			std::string ss = account->Serializer();
-			std::string index = DecodeAddress(it->first);
+			std::string ss = accounts[i]->Serializer();
+			std::string index = DecodeAddress(addresses[i]);
 			bool is_new = trie->Set(index, ss);
 			if (is_new){
 				new_count++;
@@ -34,6 +34,8 @@ namespace bumo {
 		bool exec_result_;
 		protocol::ConsensusValueValidation cons_validation_;
 		std::set<int32_t> need_dropped_tx_;
+		//the txs from this index on were not applied for the time budget, -1 : all applied
+		int32_t sealed_count_;
 
 		void SetApply(ProposeTxsResult &result);
 	};
@@ -75,6 +77,8 @@ namespace bumo {
 		// void GetSqlTx(std::string &sqltx, std::string &sql_account_tx);
 
 		bool AddToDb(WRITE_BATCH& batch);
+		//put the ledger and its transactions into the batch without writing it
+		void AddToBatch(WRITE_BATCH& batch);
 
 		bool LoadFromDb(int64_t seq);
 
@@ -102,6 +106,8 @@ namespace bumo {
 
 		Json::Value ToJson();
 
+		//the accounts the ledger writes to the trie
+		void GetChangedAccounts(std::vector<std::string> &addresses, std::vector<std::shared_ptr<AccountFrm>> &accounts);
 		bool Commit(KVTrie* trie, int64_t& new_count, int64_t& change_count);
 
 		bool AllocateReward();
@@ -109,6 +115,9 @@ namespace bumo {
 		void SetTestMode(bool test_mode);
 		bool IsTestMode();
 
+		//create the transaction frames of the set, the signatures are verified on the worker pool
+		static void InitTransactions(const protocol::TransactionEnvSet &txset, std::vector<TransactionFrm::pointer> &tx_frms);
+
 	private:
 		protocol::Ledger ledger_;
 		bool is_test_mode_;
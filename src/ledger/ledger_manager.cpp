@@ -20,6 +20,7 @@
 #include "ledger_manager.h"
 #include "contract_manager.h"
 #include "fee_calculate.h"
+#include "parallel_executor.h"
 
 namespace bumo {
 	LedgerManager::LedgerManager() : tree_(NULL) {
@@ -58,7 +59,24 @@ namespace bumo {
 		auto batch = std::make_shared<WRITE_BATCH>();
 		tree_->Init(Storage::Instance().account_db(), batch, General::ACCOUNT_PREFIX, 4);
 
-		context_manager_.Initialize();
+		if (!context_manager_.Initialize()) {
+			return false;
+		}
+		signature_cache_.Initialize(Configure::Instance().ledger_configure_.signature_cache_size_);
+		node_cache_.Initialize(Configure::Instance().ledger_configure_.trie_node_cache_size_);
+		tx_journal_.Initialize(Configure::Instance().ledger_configure_.tx_journal_size_);
+		account_cache_.Initialize(Configure::Instance().ledger_configure_.account_cache_size_);
+		query_cache_.Initialize(Configure::Instance().ledger_configure_.contract_query_cache_size_);
+
+		uint32_t worker_count = Configure::Instance().ledger_configure_.worker_thread_count_;
+		if (worker_count == 0) {
+			worker_count = utils::System::GetCpuCoreCount();
+		}
+		utils::EccSm2::GetCFCAGroup(); //create the group before the workers verify sm2 signatures
+		if (!worker_pool_.Init("ledger", worker_count)) {
+			LOG_ERROR("Initialize ledger worker pool failed");
+			return false;
+		}
 
 		auto kvdb = Storage::Instance().account_db();
 		std::string str_max_seq;
@@ -66,6 +84,9 @@ namespace bumo {
 		if (kvdb->Get(General::KEY_LEDGER_SEQ, str_max_seq)) {
 			seq_kvdb = utils::String::Stoi64(str_max_seq);
 			int64_t seq_rational = GetMaxLedger();
+			if (seq_rational == seq_kvdb + 1 && RollbackLedgerDb(seq_rational)) {
+				seq_rational = seq_kvdb;
+			}
 			if (seq_kvdb != seq_rational) {
 				LOG_ERROR("fatal error:ledger_seq from kvdb(" FMT_I64 ") != ledger_seq from rational db(" FMT_I64 ")",
 					seq_kvdb, seq_rational);
@@ -90,11 +111,15 @@ namespace bumo {
 			statistics_.fromString(str);
 		}
 		//avoid dead lock
+		StateView::pointer state_view = std::make_shared<StateView>(last_closed_ledger_->GetProtoHeader());
 		utils::WriteLockGuard guard(lcl_header_mutex_);
 		lcl_header_ = last_closed_ledger_->GetProtoHeader();
+		state_view_ = state_view;
 
 		tree_->UpdateHash();
 		const protocol::LedgerHeader& lclheader = last_closed_ledger_->GetProtoHeader();
+		account_cache_.Reset(lclheader.seq());
+		query_cache_.Reset(lclheader.seq());
 		std::string validators_hash = lclheader.validators_hash();
 		if (!ValidatorsGet(validators_hash, validators_)) {
 			LOG_ERROR("Get validators failed!");
@@ -138,6 +163,12 @@ namespace bumo {
 	bool LedgerManager::Exit() {
 		LOG_INFO("Ledger manager stoping...");
 
+		context_manager_.Exit();
+		worker_pool_.Exit();
+		do {
+			utils::WriteLockGuard guard(lcl_header_mutex_);
+			state_view_ = nullptr;
+		} while (false);
 		if (tree_) {
 			delete tree_;
 			tree_ = NULL;
@@ -215,6 +246,11 @@ namespace bumo {
 		return lcl_header_;
 	}
 
+	StateView::pointer LedgerManager::GetStateView() {
+		utils::ReadLockGuard guard(lcl_header_mutex_);
+		return state_view_;
+	}
+
 	void LedgerManager::ValidatorsSet(std::shared_ptr<WRITE_BATCH> batch, const protocol::ValidatorSet& validators) {
 		//should be recode ?
 		std::string hash = HashWrapper::Crypto(validators.SerializeAsString());
@@ -488,6 +524,65 @@ namespace bumo {
 		return utils::String::Stoi64(str_value);
 	}
 
+	bool LedgerManager::RollbackLedgerDb(int64_t seq) {
+		KeyValueDb *ledger_db = Storage::Instance().ledger_db();
+		WRITE_BATCH batch;
+		std::string str_value;
+		if (ledger_db->Get(ComposePrefix(General::LEDGER_TRANSACTION_PREFIX, seq), str_value) > 0) {
+			protocol::EntryList list;
+			if (!list.ParseFromString(str_value)) {
+				LOG_ERROR("Parse transaction list of ledger(" FMT_I64 ") failed", seq);
+				return false;
+			}
+			for (int32_t i = 0; i < list.entry_size(); i++) {
+				batch.Delete(ComposePrefix(General::TRANSACTION_PREFIX, list.entry(i)));
+			}
+
+			//the last tx hashs were written with the ledger, build them again from the ledgers before it
+			if (list.entry_size() > 0) {
+				protocol::EntryList last_hashs;
+				for (int64_t i = seq - 1; i > 0 && last_hashs.entry_size() < General::LAST_TX_HASHS_LIMIT; i--) {
+					int32_t ret = ledger_db->Get(ComposePrefix(General::LEDGER_TRANSACTION_PREFIX, i), str_value);
+					if (ret < 0) {
+						LOG_ERROR("Load transaction list of ledger(" FMT_I64 ") failed, error desc(%s)", i, ledger_db->error_desc().c_str());
+						return false;
+					}
+					else if (ret == 0) {
+						break;
+					}
+
+					protocol::EntryList prev_list;
+					if (!prev_list.ParseFromString(str_value)) {
+						LOG_ERROR("Parse transaction list of ledger(" FMT_I64 ") failed", i);
+						return false;
+					}
+					for (int32_t j = prev_list.entry_size() - 1; j >= 0 && last_hashs.entry_size() < General::LAST_TX_HASHS_LIMIT; j--) {
+						*last_hashs.add_entry() = prev_list.entry(j);
+					}
+				}
+
+				if (last_hashs.entry_size() > 0) {
+					batch.Put(General::LAST_TX_HASHS, last_hashs.SerializeAsString());
+				}
+				else {
+					batch.Delete(General::LAST_TX_HASHS);
+				}
+			}
+		}
+
+		batch.Delete(ComposePrefix(General::LEDGER_TRANSACTION_PREFIX, seq));
+		batch.Delete(ComposePrefix(General::LEDGER_PREFIX, seq));
+		batch.Delete(ComposePrefix(General::CONSENSUS_VALUE_PREFIX, seq));
+		batch.Put(General::KEY_LEDGER_SEQ, utils::String::ToString(seq - 1));
+		if (!ledger_db->WriteBatch(batch)) {
+			LOG_ERROR("Rollback ledger(" FMT_I64 ") failed, error desc(%s)", seq, ledger_db->error_desc().c_str());
+			return false;
+		}
+
+		LOG_WARN("Ledger(" FMT_I64 ") was written to the ledger db without its accounts, rolled back", seq);
+		return true;
+	}
+
 	void LedgerManager::GetModuleStatus(Json::Value &data) {
 		utils::MutexGuard guard(gmutex_);
 		int64_t begin_time = utils::Timestamp::HighResolution();
@@ -500,6 +595,13 @@ namespace bumo {
 		data["hash_type"] = HashWrapper::GetLedgerHashType() == HashWrapper::HASH_TYPE_SM3 ? "sm3" : "sha256";
 		data["sync"] = sync_.ToJson();
 		context_manager_.GetModuleStatus(data["ledger_context"]);
+		signature_cache_.GetModuleStatus(data["signature_cache"]);
+		node_cache_.GetModuleStatus(data["trie_node_cache"]);
+		tx_journal_.GetModuleStatus(data["tx_journal"]);
+		account_cache_.GetModuleStatus(data["account_cache"]);
+		query_cache_.GetModuleStatus(data["contract_query_cache"]);
+		ContractManager::Instance().code_cache_.GetModuleStatus(data["contract_code_cache"]);
+		ParallelExecutor::GetModuleStatus(data["parallel_executor"]);
 
 		data["chain_max_ledger_seq"] = chain_max_ledger_probaly_ > data["ledger_sequence"].asInt64() ?
 		chain_max_ledger_probaly_ : data["ledger_sequence"].asInt64();
@@ -541,7 +643,7 @@ namespace bumo {
 
 		int64_t time1 = utils::Timestamp().HighResolution();
 
-		tree_->UpdateHash();
+		tree_->UpdateHash(&worker_pool_);
 		int64_t time2 = utils::Timestamp().HighResolution();
 
 		header->set_account_tree_hash(tree_->GetRootHash());
@@ -600,7 +702,12 @@ namespace bumo {
 		WRITE_BATCH ledger_db_batch;
 		ledger_db_batch.Put(ComposePrefix(General::CONSENSUS_VALUE_PREFIX, consensus_value.ledger_seq()), consensus_value.SerializeAsString());
 
-		if (!closing_ledger->AddToDb(ledger_db_batch)) {
+		if (Storage::Instance().IsSingleDb()) {
+			//the ledger and the accounts in one write
+			closing_ledger->AddToBatch(ledger_db_batch);
+			KeyValueDb::AppendBatch(*account_db_batch, ledger_db_batch);
+		}
+		else if (!closing_ledger->AddToDb(ledger_db_batch)) {
 			PROCESS_EXIT("AddToDb failed");
 		}
 
@@ -611,6 +718,11 @@ namespace bumo {
 		//write successful, then update the variable
 		last_closed_ledger_ = closing_ledger;
 
+		std::vector<std::string> changed_addresses;
+		std::vector<std::shared_ptr<AccountFrm>> changed_accounts;
+		closing_ledger->GetChangedAccounts(changed_addresses, changed_accounts);
+		account_cache_.Update(ledger_seq, changed_accounts);
+
 		int64_t time3 = utils::Timestamp().HighResolution();
 		tree_->batch_ = std::make_shared<WRITE_BATCH>();
 		tree_->FreeMemory(4);
@@ -634,10 +746,14 @@ namespace bumo {
 	void LedgerManager::NotifyLedgerClose(LedgerFrm::pointer closing_ledger, bool has_upgrade) {
 		//avoid dead lock
 		protocol::LedgerHeader tmp_lcl_header;
+		StateView::pointer state_view = std::make_shared<StateView>(last_closed_ledger_->GetProtoHeader());
 		do {
 			utils::WriteLockGuard guard(lcl_header_mutex_);
 			tmp_lcl_header = lcl_header_ = last_closed_ledger_->GetProtoHeader();
+			state_view_ = state_view;
 		} while (false);
+		//after the new state is seen, or a query of the old state is cached as the new one
+		query_cache_.Reset(tmp_lcl_header.seq());
 
 		protocol::ValidatorSet tmp_v = validators_;
 		std::string tmp_proof = proof_;
@@ -647,6 +763,8 @@ namespace bumo {
 		});
 
 		context_manager_.RemoveCompleted(tmp_lcl_header.seq());
+		//the entries were applied on top of the previous ledger
+		tx_journal_.Clear();
 
 		//notice ledger closed
 		WebSocketServer::Instance().BroadcastMsg(protocol::CHAIN_LEDGER_HEADER, tmp_lcl_header.SerializeAsString());
@@ -28,6 +28,11 @@
 #include "ledgercontext_manager.h"
 #include "environment.h"
 #include "kv_trie.h"
+#include "signature_cache.h"
+#include "tx_journal.h"
+#include "account_cache.h"
+#include "contract_query_cache.h"
+#include "state_view.h"
 #include "proto/cpp/consensus.pb.h"
 
 #ifdef WIN32
@@ -55,6 +60,9 @@ namespace bumo {
 
 		protocol::LedgerHeader GetLastClosedLedger();
 
+		//state of the last closed ledger for the readers out of the ledger thread
+		StateView::pointer GetStateView();
+
 		int GetAccountNum();
 
 		void OnRequestLedgers(const protocol::GetLedgers &message, int64_t peer_id);
@@ -85,6 +93,24 @@ namespace bumo {
 		KVTrie* tree_;
 
 		LedgerContextManager context_manager_;
+
+		//cpu bound jobs of the ledger, such as signature verification
+		utils::ThreadPool worker_pool_;
+
+		//signers of the transactions verified recently
+		SignatureCache signature_cache_;
+
+		//inner nodes of the asset and metadata tries of the accounts
+		TrieNodeCache node_cache_;
+
+		//state changes of the transactions applied on top of the last closed ledger
+		TransactionJournal tx_journal_;
+
+		//decoded accounts of the last closed ledger
+		AccountCache account_cache_;
+
+		//results of the contract queries on the last closed ledger
+		ContractQueryCache query_cache_;
 	private:
 		LedgerManager();
 		~LedgerManager();
@@ -92,6 +118,8 @@ namespace bumo {
 		void RequestConsensusValues(int64_t pid, protocol::GetLedgers& gl, int64_t time);
 
 		int64_t GetMaxLedger();
+		//drop a ledger which was written to the ledger db while its accounts were not
+		bool RollbackLedgerDb(int64_t seq);
 
 		bool CloseLedger(const protocol::ConsensusValue& request, const std::string& proof);
 
@@ -108,6 +136,7 @@ namespace bumo {
 
 		utils::ReadWriteLock lcl_header_mutex_;
 		protocol::LedgerHeader lcl_header_;
+		StateView::pointer state_view_;
 		int64_t chain_max_ledger_probaly_;
 
 		utils::ReadWriteLock fee_config_mutex_;
@@ -27,7 +27,10 @@ namespace bumo {
 		start_time_(-1),
 		tx_timeout_(-1),
 		timeout_tx_index_(-1),
-		apply_mode_(LedgerFrm::APPLY_MODE_FOLLOW) {
+		apply_mode_(LedgerFrm::APPLY_MODE_FOLLOW),
+		cancelled_(false),
+		started_(false),
+		finished_(false) {
 		closing_ledger_ = std::make_shared<LedgerFrm>();
 	}
 
@@ -39,7 +42,10 @@ namespace bumo {
 		hash_(chash),
 		consensus_value_(consvalue),
 		start_time_(-1),
-		timeout_tx_index_(-1){
+		timeout_tx_index_(-1),
+		cancelled_(false),
+		started_(false),
+		finished_(false) {
 		apply_mode_ = propose ? LedgerFrm::APPLY_MODE_PROPOSE : LedgerFrm::APPLY_MODE_CHECK;
 		closing_ledger_ = std::make_shared<LedgerFrm>();
 	}
@@ -50,7 +56,10 @@ namespace bumo {
 		const ContractTestParameter &parameter) :
 		type_(type), 
 		parameter_(parameter),
-		lpmanager_(NULL) {
+		lpmanager_(NULL),
+		cancelled_(false),
+		started_(false),
+		finished_(false) {
 		apply_mode_ = LedgerFrm::APPLY_MODE_PROPOSE;
 		closing_ledger_ = std::make_shared<LedgerFrm>();
 	}
@@ -61,33 +70,79 @@ namespace bumo {
 		type_(type),
 		consensus_value_(consensus_value),
 		lpmanager_(NULL),
-		tx_timeout_(timeout) {
+		tx_timeout_(timeout),
+		cancelled_(false),
+		started_(false),
+		finished_(false) {
 		apply_mode_ = LedgerFrm::APPLY_MODE_PROPOSE;
 		closing_ledger_ = std::make_shared<LedgerFrm>();
 	}
 	LedgerContext::~LedgerContext() {}
 
-	void LedgerContext::Run() {
+	void LedgerContext::Run(utils::Thread *this_thread) {
 		LOG_INFO("Thread preprocessing the consensus value, ledger seq(" FMT_I64 ")", consensus_value_.ledger_seq());
-		start_time_ = utils::Timestamp::HighResolution();
-		switch (type_)
-		{
-		case AT_NORMAL:
-			Do();
-			break;
-		case AT_TEST_V8:
-			TestV8();
-			break;
-		case AT_TEST_EVM:
-			LOG_ERROR("Test evm not support");
-			break;
-		case AT_TEST_TRANSACTION:
-			TestTransaction();
-			break;
-		default:
-			LOG_ERROR("LedgerContext action type unknown");
-			break;
+		do {
+			std::lock_guard<std::mutex> guard(done_lock_);
+			start_time_ = utils::Timestamp::HighResolution();
+			started_ = true;
+			done_cond_.notify_all();
+		} while (false);
+
+		bool cancelled = false;
+		do {
+			utils::MutexGuard guard(lock_);
+			cancelled = cancelled_;
+		} while (false);
+
+		if (cancelled) {
+			//cancelled while waiting in the pool
+			LOG_ERROR("Preprocessing the consensus value was cancelled before start, ledger seq(" FMT_I64 ")", consensus_value_.ledger_seq());
+			if (lpmanager_) {
+				lpmanager_->MoveRunningToDelete(this);
+			}
 		}
+		else {
+			switch (type_)
+			{
+			case AT_NORMAL:
+				Do();
+				break;
+			case AT_TEST_V8:
+				TestV8();
+				break;
+			case AT_TEST_EVM:
+				LOG_ERROR("Test evm not support");
+				break;
+			case AT_TEST_TRANSACTION:
+				TestTransaction();
+				break;
+			default:
+				LOG_ERROR("LedgerContext action type unknown");
+				break;
+			}
+		}
+
+		std::lock_guard<std::mutex> guard(done_lock_);
+		finished_ = true;
+		done_cond_.notify_all();
+	}
+
+	bool LedgerContext::WaitDone(int64_t timeout) {
+		std::unique_lock<std::mutex> guard(done_lock_);
+		if (timeout < 0) {
+			done_cond_.wait(guard, [this]() { return finished_; });
+			return true;
+		}
+
+		return done_cond_.wait_for(guard, std::chrono::microseconds(timeout), [this]() { return finished_; });
+	}
+
+	bool LedgerContext::WaitRun(int64_t timeout) {
+		std::unique_lock<std::mutex> guard(done_lock_);
+		done_cond_.wait(guard, [this]() { return started_ || finished_; });
+
+		int64_t left = start_time_ + timeout - utils::Timestamp::HighResolution();
+		return done_cond_.wait_for(guard, std::chrono::microseconds(left > 0 ? left : 0), [this]() { return finished_; });
 	}
 
 	void LedgerContext::Do() {
@@ -125,6 +180,7 @@ namespace bumo {
 	bool LedgerContext::TestV8() {
 		//if address not exist, then create temporary account
 		std::shared_ptr<Environment> environment = std::make_shared<Environment>(nullptr);
+		environment->state_view_ = state_view_;
 		if (parameter_.contract_address_.empty()) {
 			//create a temporary account
 			PrivateKey priv_key(SIGNTYPE_ED25519);
@@ -144,7 +200,7 @@ namespace bumo {
 		}
 
 		AccountFrm::pointer null_acc;
-		if (!Environment::AccountFromDB(parameter_.source_address_, null_acc)) {
+		if (!environment->GetFromDB(parameter_.source_address_, null_acc)) {
 			if (!PublicKey::IsAddressValid(parameter_.source_address_)) {
 				PrivateKey priv_key(SIGNTYPE_ED25519);
 				parameter_.source_address_ = priv_key.GetEncAddress();
@@ -164,7 +220,7 @@ namespace bumo {
 			}
 		}
 
-		protocol::LedgerHeader lcl = LedgerManager::Instance().GetLastClosedLedger();
+		protocol::LedgerHeader lcl = GetLastClosedLedger();
 		consensus_value_.set_ledger_seq(lcl.seq() + 1);
 		consensus_value_.set_close_time(lcl.close_time() + 1);
 
@@ -206,7 +262,7 @@ namespace bumo {
 					break;
 				}
 				bumo::AccountFrm::pointer account_frm = nullptr;
-				if (!Environment::AccountFromDB(parameter_.contract_address_, account_frm)) {
+				if (!environment->GetFromDB(parameter_.contract_address_, account_frm)) {
 					LOG_ERROR("not found account");
 					break;
 				}
@@ -255,6 +311,7 @@ namespace bumo {
 		std::stack<int64_t> copy_stack;
 		do {
 			utils::MutexGuard guard(lock_);
+			cancelled_ = true;
 			copy_stack = contract_ids_;
 		} while (false);
 
@@ -264,7 +321,19 @@ namespace bumo {
 			copy_stack.pop();
 		}
 
-		JoinWithStop();
+		WaitDone(-1);
+	}
+
+	bool LedgerContext::IsCancelled() {
+		utils::MutexGuard guard(lock_);
+		return cancelled_;
+	}
+
+	protocol::LedgerHeader LedgerContext::GetLastClosedLedger() {
+		if (state_view_) {
+			return state_view_->GetHeader();
+		}
+		return LedgerManager::Instance().GetLastClosedLedger();
 	}
 
 	bool LedgerContext::CheckExpire(int64_t total_timeout) {
@@ -345,8 +414,39 @@ namespace bumo {
 	LedgerContextManager::~LedgerContextManager() {
 	}
 
-	void LedgerContextManager::Initialize() {
+	bool LedgerContextManager::Initialize() {
+		uint32_t process_count = Configure::Instance().ledger_configure_.process_thread_count_;
+		if (process_count == 0) {
+			process_count = utils::System::GetCpuCoreCount();
+		}
+		if (!process_pool_.Init("process-value", process_count)) {
+			LOG_ERROR("Initialize process value pool failed");
+			return false;
+		}
+
+		if (!test_pool_.Init("test", utils::System::GetCpuCoreCount())) {
+			LOG_ERROR("Initialize test pool failed");
+			return false;
+		}
+
+		uint32_t query_count = Configure::Instance().ledger_configure_.contract_query_thread_count_;
+		if (query_count == 0) {
+			query_count = utils::System::GetCpuCoreCount();
+		}
+		if (!query_pool_.Init("query", query_count)) {
+			LOG_ERROR("Initialize query pool failed");
+			return false;
+		}
+
 		TimerNotify::RegisterModule(this);
+		return true;
+	}
+
+	bool LedgerContextManager::Exit() {
+		process_pool_.Exit();
+		test_pool_.Exit();
+		query_pool_.Exit();
+		return true;
 	}
 
 	int32_t LedgerContextManager::CheckComplete(const std::string &chash) {
@@ -394,9 +494,7 @@ namespace bumo {
 		Json::Value &stat,
 		int32_t signature_number) {
 		LedgerContext *ledger_context = nullptr;
-		std::string thread_name = "test";
 		if (type == LedgerContext::AT_TEST_V8){
-			thread_name = "test-contract";
 			ledger_context = new LedgerContext(type, *((ContractTestParameter*)parameter));
 
 			do {
@@ -409,11 +507,11 @@ namespace bumo {
 				if (result.code() == protocol::ERRCODE_SUCCESS) {
 					break;
 				}
+				delete ledger_context;
 				return false;
 			} while (false);
 		}
 		else if (type == LedgerContext::AT_TEST_TRANSACTION){
-			thread_name = "test-transaction";
 			ledger_context = new LedgerContext(type, ((TransactionTestParameter*)parameter)->consensus_value_, total_timeout);
 		}
 		else {
@@ -422,31 +520,12 @@ namespace bumo {
 			return false;
 		}
 
-		if (!ledger_context->Start(thread_name)) {
-			LOG_ERROR_ERRNO("Start test thread failed",
-				STD_ERR_CODE, STD_ERR_DESC);
-			result.set_code(protocol::ERRCODE_INTERNAL_ERROR);
-			result.set_desc("Start thread failed");
-			delete ledger_context;
-			return false;
-		}
-
-		int64_t time_start = utils::Timestamp::HighResolution();
-		bool is_timeout = false;
-		while (ledger_context->IsRunning()) {
-			utils::Sleep(10);
-			if (utils::Timestamp::HighResolution() - time_start > total_timeout) {
-				is_timeout = true;
-				break;
-			}
-		}
-
-		if (is_timeout) { //cancel it
+		test_pool_.AddTask(ledger_context);
+		if (!ledger_context->WaitDone(total_timeout)) { //cancel it
 			ledger_context->Cancel();
 			result.set_code(protocol::ERRCODE_TX_TIMEOUT);
 			result.set_desc("Execute contract timeout");
 			LOG_ERROR("Test consvalue time(" FMT_I64 "ms) is out", total_timeout / utils::MICRO_UNITS_PER_MILLI);
-			ledger_context->JoinWithStop();
 			delete ledger_context;
 			return false;
 		}
@@ -501,11 +580,48 @@ namespace bumo {
 
 		ledger_context->GetLogs(logs);
 		ledger_context->GetRets(rets);
-		ledger_context->JoinWithStop();
 		delete ledger_context;
 		return true;
 	}
 
+	bool LedgerContextManager::SyncQueryProcess(const std::string &address,
+		const std::string &code,
+		const std::string &input,
+		StateView::pointer state_view,
+		int64_t total_timeout,
+		Json::Value &result) {
+		ContractTestParameter parameter;
+		parameter.exe_or_query_ = false;
+		parameter.contract_address_ = address;
+		parameter.code_ = code;
+		parameter.input_ = input;
+		LedgerContext *ledger_context = new LedgerContext(LedgerContext::AT_TEST_V8, parameter);
+		ledger_context->state_view_ = state_view;
+
+		query_pool_.AddTask(ledger_context);
+		if (!ledger_context->WaitDone(total_timeout)) { //cancel it
+			ledger_context->Cancel();
+			Json::Value &error_obj = result["error"];
+			error_obj["data"] = "Query contract timeout";
+			LOG_ERROR("Query contract(%s) time(" FMT_I64 "ms) is out", address.c_str(), total_timeout / utils::MICRO_UNITS_PER_MILLI);
+			delete ledger_context;
+			return false;
+		}
+
+		Json::Value rets;
+		ledger_context->GetRets(rets);
+		delete ledger_context;
+		if (rets.size() == 0) {
+			Json::Value &error_obj = result["error"];
+			error_obj["data"] = "Query contract failed";
+			return false;
+		}
+
+		//the query sets the error on failure
+		result = rets[(Json::UInt)0];
+		return !result.isMember("error");
+	}
+
 	bool LedgerContextManager::SyncPreProcess(const protocol::ConsensusValue &consensus_value, bool propose, ProposeTxsResult &propose_result) {
 
 		std::string con_str = consensus_value.SerializeAsString();
@@ -516,27 +632,12 @@ namespace bumo {
 			return check_complete == 1;
 		} 
 
+		//the context moves itself to the completed or the deleted contexts when it ends
 		LedgerContext *ledger_context = new LedgerContext(this, chash, consensus_value, propose);
-
-		if (!ledger_context->Start("process-value")) {
-			LOG_ERROR_ERRNO("Start process value thread failed, consvalue hash(%s)", utils::String::BinToHexString(chash).c_str(), 
-				STD_ERR_CODE, STD_ERR_DESC);
-
-			propose_result.block_timeout_ = true;
-			delete ledger_context;
-			return false;
-		}
-
 		int64_t time_start = utils::Timestamp::HighResolution();
-		while (ledger_context->IsRunning()) {
-			utils::Sleep(10);
-			if (utils::Timestamp::HighResolution() - time_start > General::BLOCK_EXECUTE_TIME_OUT) {
-				propose_result.block_timeout_ = true;
-				break;
-			}
-		}
-
-		if (propose_result.block_timeout_) { //cancel it
+		process_pool_.AddTask(ledger_context);
+		if (!ledger_context->WaitRun(General::BLOCK_EXECUTE_TIME_OUT)) { //cancel it
+			propose_result.block_timeout_ = true;
 			ledger_context->Cancel();
 			LOG_ERROR("Pre execute consvalue time(" FMT_I64 "ms) is out", (utils::Timestamp::HighResolution() - time_start) / utils::MICRO_UNITS_PER_MILLI);
 			return false;
@@ -546,6 +647,25 @@ namespace bumo {
 		return propose_result.exec_result_;
 	}
 
+	bool LedgerContextManager::ReuseProposed(const std::string &proposed_hash, const protocol::ConsensusValue& final_value) {
+		std::string final_hash = HashWrapper::Crypto(final_value.SerializeAsString());
+		utils::MutexGuard guard(ctxs_lock_);
+		LedgerContextMap::iterator iter = completed_ctxs_.find(proposed_hash);
+		if (iter == completed_ctxs_.end()) {
+			return false;
+		}
+
+		//the applied txs and the validation are the same as the final value
+		LedgerContext *ledger_context = iter->second;
+		completed_ctxs_.erase(iter);
+		ledger_context->hash_ = final_hash;
+		ledger_context->consensus_value_ = final_value;
+		ledger_context->closing_ledger_->value_ = std::make_shared<protocol::ConsensusValue>(final_value);
+		ledger_context->closing_ledger_->ProtoLedger().mutable_header()->set_consensus_value_hash(final_hash);
+		completed_ctxs_.insert(std::make_pair(final_hash, ledger_context));
+		return true;
+	}
+
 	void LedgerContextManager::RemoveCompleted(int64_t ledger_seq) {
 		utils::MutexGuard guard(ctxs_lock_);
 		for (LedgerContextMap::iterator iter = completed_ctxs_.begin();
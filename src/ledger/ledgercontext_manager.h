@@ -16,10 +16,13 @@
 #ifndef LEDGER_CONTEXT_MANAGER_H_
 #define LEDGER_CONTEXT_MANAGER_H_
 
+#include <mutex>
+#include <condition_variable>
 #include <utils/headers.h>
 #include <common/general.h>
 #include <proto/cpp/chain.pb.h>
 #include "ledger_frm.h"
+#include "state_view.h"
 #include "contract_manager.h"
 
 namespace bumo {
@@ -27,7 +30,9 @@ namespace bumo {
 	class LedgerContextManager;
 	class LedgerContext;
 	typedef std::function< void(bool check_result)> PreProcessCallback;
-	class LedgerContext : public utils::Thread {
+	//runs on the process pools of the manager, the caller waits for it with WaitDone
+	class LedgerContext : public utils::Runnable {
+		friend class LedgerContextManager;
 		std::stack<int64_t> contract_ids_; //may be called by check thread or execute thread.so need lock
 		//parameter
 		int32_t type_; // -1 : normal, 0 : test v8 , 1: test evm ,2 test transaction
@@ -41,6 +46,12 @@ namespace bumo {
 
 		Json::Value logs_;
 		Json::Value rets_;
+
+		bool cancelled_;
+		bool started_;
+		bool finished_;
+		std::mutex done_lock_;
+		std::condition_variable done_cond_;
 	public:
 		LedgerContext(
 			LedgerContextManager *lpmanager,
@@ -74,6 +85,8 @@ namespace bumo {
 		int64_t tx_timeout_;
 
 		LedgerFrm::pointer closing_ledger_;
+		//the closed ledger a query reads, null when the context runs on the live state
+		StateView::pointer state_view_;
 		std::vector<std::shared_ptr<TransactionFrm>> transaction_stack_;
 		
 		//result
@@ -84,12 +97,20 @@ namespace bumo {
 
 		utils::Mutex lock_;
 
-		virtual void Run();
+		virtual void Run(utils::Thread *this_thread);
 		void Do();
 		bool TestV8();
 		bool TestTransaction();
+		//cancel the running contracts and wait for the run to end
 		void Cancel();
+		bool IsCancelled();
+		//wait for the run to end, timeout in micro seconds, < 0 : no timeout
+		bool WaitDone(int64_t timeout);
+		//same as WaitDone, but the time in the pool queue is not counted
+		bool WaitRun(int64_t timeout);
 		bool CheckExpire(int64_t total_timeout);
+		//the header of the state view if there is one, else the last closed ledger
+		protocol::LedgerHeader GetLastClosedLedger();
 		
 		void PushContractId(int64_t id);
 		void PopContractId();
@@ -118,11 +139,18 @@ namespace bumo {
 		LedgerContextMultiMap running_ctxs_;
 		LedgerContextMap completed_ctxs_;
 		LedgerContextTimeMultiMap delete_ctxs_;
+
+		//the propose and check values, apart from the tests so a slow test never delays consensus
+		utils::ThreadPool process_pool_;
+		utils::ThreadPool test_pool_;
+		//the read only queries of the contracts, the isolates of the workers are reused
+		utils::ThreadPool query_pool_;
 	public:
 		LedgerContextManager();
 		~LedgerContextManager();
 
-		void Initialize();
+		bool Initialize();
+		bool Exit();
 		virtual void OnTimer(int64_t current_time);
 		virtual void OnSlowTimer(int64_t current_time);
 		void MoveRunningToComplete(LedgerContext *ledger_context);
@@ -139,10 +167,19 @@ namespace bumo {
 			Json::Value &rets,
 			Json::Value &stat,
 			int32_t signature_number = 0);
+		//query the contract of the address on the closed ledger of the view, the result is the return of the query
+		bool SyncQueryProcess(const std::string &address,
+			const std::string &code,
+			const std::string &input,
+			StateView::pointer state_view,
+			int64_t total_timeout,
+			Json::Value &result);
 
 		//<0 : notfound 1: found and success 0: found and failed
 		int32_t CheckComplete(const std::string &chash);
 		bool SyncPreProcess(const protocol::ConsensusValue& consensus_value, bool propose, ProposeTxsResult &propose_result);
+		//the proposed value was sealed or had txs dropped, its completed result is the result of the final value
+		bool ReuseProposed(const std::string &proposed_hash, const protocol::ConsensusValue& final_value);
 
 		//<0 : processing 1: found and success 0: found and failed
 //		int32_t AsyncPreProcess(const protocol::ConsensusValue& consensus_value, int64_t timeout, PreProcessCallback callback, int32_t &timeout_tx_index);
@@ -0,0 +1,261 @@
+/*
+	bumo is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	bumo is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with bumo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "parallel_executor.h"
+#include "ledger_manager.h"
+#include "ledgercontext_manager.h"
+
+namespace bumo {
+
+	//the environment of a speculative run, it reads the prefetched accounts only
+	class SpeculativeEnvironment : public Environment {
+	public:
+		SpeculativeEnvironment(mapKV *data, settingKV *settings, const std::set<std::string> *absent) :
+			Environment(data, settings),
+			absent_(absent),
+			missed_(false) {}
+
+		virtual bool GetFromDB(const std::string &address, AccountFrm::pointer &account_ptr) {
+			//an account not prefetched can't be read on the pool, the run is given up
+			if (absent_->find(address) == absent_->end()) {
+				missed_ = true;
+			}
+			absent_reads_.insert(address);
+			return false;
+		}
+
+		bool Missed() const {
+			return missed_;
+		}
+
+		void GetTouched(std::set<std::string> &touched) {
+			touched = absent_reads_;
+			const mapKV &buf = GetActionBuf();
+			for (auto it = buf.begin(); it != buf.end(); it++) {
+				touched.insert(it->first);
+			}
+		}
+
+	private:
+		const std::set<std::string> *absent_;
+		std::set<std::string> absent_reads_;
+		bool missed_;
+	};
+
+	utils::Mutex ParallelExecutor::stat_lock_;
+	int64_t ParallelExecutor::speculated_count_ = 0;
+	int64_t ParallelExecutor::reused_count_ = 0;
+	int64_t ParallelExecutor::reapplied_count_ = 0;
+
+	ParallelExecutor::ParallelExecutor(LedgerFrm *ledger_frm, std::shared_ptr<Environment> environment) :
+		ledger_frm_(ledger_frm),
+		environment_(environment) {
+		enabled_ = Configure::Instance().ledger_configure_.parallel_execute_ &&
+			environment_->useAtomMap_ && !ledger_frm_->IsTestMode();
+	}
+
+	ParallelExecutor::~ParallelExecutor() {}
+
+	bool ParallelExecutor::CollectAddresses(TransactionFrm::pointer tx_frm, std::set<std::string> &addresses) {
+		const protocol::Transaction &tx = tx_frm->GetTx();
+		addresses.insert(tx.source_address());
+		for (int32_t i = 0; i < tx.operations_size(); i++) {
+			const protocol::Operation &ope = tx.operations(i);
+			if (!ope.source_address().empty()) {
+				addresses.insert(ope.source_address());
+			}
+
+			switch (ope.type()) {
+			case protocol::Operation_Type_CREATE_ACCOUNT:
+				if (!ope.create_account().contract().payload().empty()) {
+					return false;
+				}
+				addresses.insert(ope.create_account().dest_address());
+				break;
+			case protocol::Operation_Type_PAY_ASSET:
+				addresses.insert(ope.pay_asset().dest_address());
+				break;
+			case protocol::Operation_Type_PAY_COIN:
+				addresses.insert(ope.pay_coin().dest_address());
+				break;
+			default:
+				break;
+			}
+		}
+
+		return true;
+	}
+
+	void ParallelExecutor::Speculate(const protocol::ConsensusValue &value,
+		const std::vector<TransactionFrm::pointer> &tx_frms,
+		const std::set<int32_t> &skipped) {
+		if (!enabled_) {
+			return;
+		}
+
+		speculations_.resize(tx_frms.size());
+		std::vector<int32_t> candidates;
+		std::set<std::string> addresses;
+		for (int32_t i = 0; i < (int32_t)tx_frms.size(); i++) {
+			if (skipped.find(i) == skipped.end() && CollectAddresses(tx_frms[i], addresses)) {
+				candidates.push_back(i);
+			}
+		}
+
+		//the account trie is not thread safe, the accounts are loaded before the runs
+		for (auto it = addresses.begin(); it != addresses.end(); it++) {
+			AccountFrm::pointer account;
+			if (Environment::AccountFromDB(*it, account)) {
+				base_[*it] = Environment::ActValue(account, Environment::ADD);
+			}
+			else {
+				absent_.insert(*it);
+			}
+		}
+		JournalEntry::CopySettings(environment_->settings_.GetData(), settings_);
+
+		//the runs don't read the txs of the value
+		protocol::ConsensusValue header = value;
+		header.clear_txset();
+
+		utils::ThreadPool &pool = LedgerManager::Instance().worker_pool_;
+		size_t total = candidates.size();
+		size_t slice = total / (pool.Size() + 1) + 1;
+		std::vector<utils::ThreadCallback> jobs;
+		for (size_t begin = 0; begin < total; begin += slice) {
+			size_t end = MIN(begin + slice, total);
+			jobs.push_back([this, &header, &tx_frms, &candidates, begin, end]() {
+				LedgerContext context("", header);
+				context.closing_ledger_->value_ = std::make_shared<protocol::ConsensusValue>(header);
+				context.closing_ledger_->lpledger_context_ = &context;
+				for (size_t i = begin; i < end; i++) {
+					Run(context, tx_frms[candidates[i]], speculations_[candidates[i]]);
+				}
+			});
+		}
+
+		pool.Execute(jobs);
+
+		utils::MutexGuard guard(stat_lock_);
+		speculated_count_ += total;
+	}
+
+	void ParallelExecutor::Run(LedgerContext &context, TransactionFrm::pointer origin, Speculation &speculation) {
+		//the frame of the loop must not see the run
+		TransactionFrm::pointer tx_frm = std::make_shared<TransactionFrm>(*origin);
+		std::shared_ptr<SpeculativeEnvironment> environment = std::make_shared<SpeculativeEnvironment>(&base_, &settings_, &absent_);
+		LedgerFrm *ledger_frm = context.closing_ledger_.get();
+
+		//a payment to a contract runs the contract, it is applied in the loop
+		const protocol::Transaction &tx = tx_frm->GetTx();
+		for (int32_t i = 0; i < tx.operations_size(); i++) {
+			const protocol::Operation &ope = tx.operations(i);
+			std::string dest_address;
+			if (ope.type() == protocol::Operation_Type_PAY_ASSET) {
+				dest_address = ope.pay_asset().dest_address();
+			}
+			else if (ope.type() == protocol::Operation_Type_PAY_COIN) {
+				dest_address = ope.pay_coin().dest_address();
+			}
+
+			AccountFrm::pointer dest_account;
+			if (!dest_address.empty() && environment->GetEntry(dest_address, dest_account) &&
+				!dest_account->GetProtoAccount().contract().payload().empty()) {
+				return;
+			}
+		}
+
+		if (!tx_frm->ValidForApply(environment)) {
+			return;
+		}
+
+		int64_t total_fee = 0;
+		if (!tx_frm->PayFee(environment, total_fee)) {
+			return;
+		}
+
+		context.transaction_stack_.push_back(tx_frm);
+		tx_frm->NonceIncrease(ledger_frm, environment);
+		tx_frm->EnableChecked();
+		tx_frm->SetMaxEndTime(utils::Timestamp::HighResolution() + General::TX_EXECUTE_TIME_OUT);
+		bool ret = tx_frm->Apply(ledger_frm, environment);
+		context.transaction_stack_.pop_back();
+
+		std::string error_info;
+		if (tx_frm->IsExpire(error_info) || environment->Missed() || !environment->settings_.GetActionBuf().empty()) {
+			return;
+		}
+
+		speculation.entry_ = std::make_shared<JournalEntry>();
+		tx_frm->ToJournal(*speculation.entry_, ret);
+		environment->GetTouched(speculation.touched_);
+	}
+
+	bool ParallelExecutor::IsValid(int32_t index) {
+		if (!enabled_ || index < 0 || index >= (int32_t)speculations_.size() || speculations_[index].entry_ == nullptr) {
+			return false;
+		}
+
+		const std::set<std::string> &touched = speculations_[index].touched_;
+		for (auto it = touched.begin(); it != touched.end(); it++) {
+			if (written_.find(*it) != written_.end()) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool ParallelExecutor::Apply(int32_t index, TransactionFrm::pointer tx_frm, JournalEntry::pointer recorded) {
+		bool ret = false;
+		if (recorded != nullptr) {
+			ret = tx_frm->ApplyJournal(ledger_frm_, environment_, *recorded);
+		}
+		else if (IsValid(index)) {
+			ret = tx_frm->ApplyJournal(ledger_frm_, environment_, *speculations_[index].entry_);
+			utils::MutexGuard guard(stat_lock_);
+			reused_count_++;
+		}
+		else {
+			ret = tx_frm->Apply(ledger_frm_, environment_);
+			if (enabled_ && index < (int32_t)speculations_.size() && speculations_[index].entry_ != nullptr) {
+				utils::MutexGuard guard(stat_lock_);
+				reapplied_count_++;
+			}
+		}
+
+		if (enabled_) {
+			written_.insert(tx_frm->GetSourceAddress());
+			const Environment::mapKV &buf = environment_->GetActionBuf();
+			for (auto it = buf.begin(); it != buf.end(); it++) {
+				written_.insert(it->first);
+			}
+		}
+		return ret;
+	}
+
+	void ParallelExecutor::Skip(TransactionFrm::pointer tx_frm) {
+		if (enabled_) {
+			written_.insert(tx_frm->GetSourceAddress());
+		}
+	}
+
+	void ParallelExecutor::GetModuleStatus(Json::Value &data) {
+		utils::MutexGuard guard(stat_lock_);
+		data["enabled"] = Configure::Instance().ledger_configure_.parallel_execute_;
+		data["speculated_count"] = speculated_count_;
+		data["reused_count"] = reused_count_;
+		data["reapplied_count"] = reapplied_count_;
+	}
+}
@@ -0,0 +1,83 @@
+/*
+	bumo is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	bumo is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with bumo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PARALLEL_EXECUTOR_H_
+#define PARALLEL_EXECUTOR_H_
+
+#include <set>
+#include <utils/thread.h>
+#include <json/json.h>
+#include "transaction_frm.h"
+#include "tx_journal.h"
+
+namespace bumo {
+
+	class LedgerFrm;
+	class LedgerContext;
+
+	//runs the transactions of a value speculatively on the worker pool before the apply loop.
+	//every run reads the state before the value, the loop takes the result of a run only if
+	//no transaction before it touched the accounts the run touched, otherwise the transaction
+	//is applied again, so the result is the same as applying them one by one.
+	//the transactions calling contracts or touching the settings are always applied in the loop
+	class ParallelExecutor {
+	public:
+		ParallelExecutor(LedgerFrm *ledger_frm, std::shared_ptr<Environment> environment);
+		~ParallelExecutor();
+
+		//run the transactions except the skipped ones, the environment is not changed
+		void Speculate(const protocol::ConsensusValue &value,
+			const std::vector<TransactionFrm::pointer> &tx_frms,
+			const std::set<int32_t> &skipped);
+
+		//apply the transaction of the index in the loop, from the recorded entry if any,
+		//then from its speculative run if the run is still valid
+		bool Apply(int32_t index, TransactionFrm::pointer tx_frm, JournalEntry::pointer recorded);
+		//the transaction is not applied, only its fee and nonce are changed
+		void Skip(TransactionFrm::pointer tx_frm);
+
+		static void GetModuleStatus(Json::Value &data);
+	private:
+		struct Speculation {
+			JournalEntry::pointer entry_;
+			std::set<std::string> touched_;
+		};
+
+		//the accounts the transaction may touch, false if it creates a contract
+		static bool CollectAddresses(TransactionFrm::pointer tx_frm, std::set<std::string> &addresses);
+		void Run(LedgerContext &context, TransactionFrm::pointer origin, Speculation &speculation);
+		bool IsValid(int32_t index);
+
+		LedgerFrm *ledger_frm_;
+		std::shared_ptr<Environment> environment_;
+		bool enabled_;
+
+		//the state before the value, read only while the runs are on the pool
+		Environment::mapKV base_;
+		Environment::settingKV settings_;
+		std::set<std::string> absent_;
+
+		std::vector<Speculation> speculations_;
+		//the accounts the transactions applied so far may have written
+		std::set<std::string> written_;
+
+		static utils::Mutex stat_lock_;
+		static int64_t speculated_count_;
+		static int64_t reused_count_;
+		static int64_t reapplied_count_;
+	};
+}
+
+#endif
@@ -0,0 +1,31 @@
+/*
+	bumo is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	bumo is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with bumo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SIGNATURE_CACHE_H_
+#define SIGNATURE_CACHE_H_
+
+#include <set>
+#include <utils/counted_lru_cache.h>
+
+namespace bumo {
+
+	//remember the signers verified for a transaction, so the same transaction
+	//is verified only once on its way from the pool to the closed ledger.
+	//the key is the hash of the whole envelope, signatures included, a transaction
+	//carrying other signatures for the same content is a different entry
+	typedef utils::CountedLruCache<std::string, std::set<std::string>> SignatureCache;
+}
+
+#endif
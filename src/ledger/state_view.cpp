@@ -0,0 +1,60 @@
+/*
+	bumo is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	bumo is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with bumo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ledger_manager.h"
+#include "state_view.h"
+
+namespace bumo {
+	StateView::StateView(const protocol::LedgerHeader &header) :
+		header_(header) {
+		snapshot_ = std::make_shared<KeyValueDbSnapshot>(Storage::Instance().account_db());
+	}
+
+	StateView::~StateView() {}
+
+	const protocol::LedgerHeader &StateView::GetHeader() const {
+		return header_;
+	}
+
+	bool StateView::AccountFromDB(const std::string &address, AccountFrm::pointer &account_ptr) {
+		//the cache holds the accounts of the last closed ledger only
+		AccountCache &cache = LedgerManager::Instance().account_cache_;
+		AccountCache::pointer cached = nullptr;
+		if (cache.Get(address, header_.seq(), cached)) {
+			account_ptr = std::make_shared<AccountFrm>(*cached);
+			account_ptr->SetSnapshot(snapshot_);
+			return true;
+		}
+
+		//a trie for each read, only the path to the account is loaded
+		KVTrie trie;
+		trie.Init(Storage::Instance().account_db(), std::make_shared<WRITE_BATCH>(), General::ACCOUNT_PREFIX,
+			header_.account_tree_hash(), &LedgerManager::Instance().node_cache_, snapshot_);
+
+		std::string buff;
+		if (!trie.Get(DecodeAddress(address), buff)) {
+			return false;
+		}
+
+		protocol::Account account;
+		if (!account.ParseFromString(buff)) {
+			PROCESS_EXIT("fatal error, account(%s) ParseFromString failed", address.c_str());
+		}
+		cache.Set(address, header_.seq(), account);
+		account_ptr = std::make_shared<AccountFrm>(account);
+		account_ptr->SetSnapshot(snapshot_);
+		return true;
+	}
+}
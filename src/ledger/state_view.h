@@ -0,0 +1,43 @@
+/*
+	bumo is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	bumo is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with bumo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef STATE_VIEW_H_
+#define STATE_VIEW_H_
+
+#include <common/storage.h>
+#include <proto/cpp/chain.pb.h>
+#include "account.h"
+
+namespace bumo {
+
+	//read-only state of a closed ledger for the api. the reads go to a db snapshot
+	//through tries of their own, so they never touch the tree the ledger is committing
+	class StateView {
+	public:
+		typedef std::shared_ptr<StateView> pointer;
+
+		StateView(const protocol::LedgerHeader &header);
+		~StateView();
+
+		const protocol::LedgerHeader &GetHeader() const;
+
+		bool AccountFromDB(const std::string &address, AccountFrm::pointer &account_ptr);
+	private:
+		protocol::LedgerHeader header_;
+		KeyValueDbSnapshot::pointer snapshot_;
+	};
+}
+
+#endif
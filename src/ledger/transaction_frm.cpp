@@ -48,7 +48,7 @@ namespace bumo {
 	}
 
 
-	TransactionFrm::TransactionFrm(const protocol::TransactionEnv &env) :
+	TransactionFrm::TransactionFrm(const protocol::TransactionEnv &env, bool verify_signature) :
 		apply_time_(0),
 		ledger_seq_(0),
 		result_(),
@@ -64,7 +64,7 @@ namespace bumo {
 		contract_stack_usage_(0),
 		enable_check_(false), apply_start_time_(0), apply_use_time_(0),
 		incoming_time_(utils::Timestamp::HighResolution()) {
-		Initialize();
+		Initialize(verify_signature);
 		utils::AtomicInc(&bumo::General::tx_new_count);
 	}
 
@@ -90,26 +90,59 @@ namespace bumo {
 		result["hash"] = utils::String::BinToHexString(hash_);
 	}
 
-	void TransactionFrm::Initialize() {
+	void TransactionFrm::Initialize(bool verify_signature) {
 		const protocol::Transaction &tran = transaction_env_.transaction();
 		data_ = tran.SerializeAsString();
 		hash_ = HashWrapper::Crypto(data_);
 		full_data_ = transaction_env_.SerializeAsString();
 		full_hash_ = HashWrapper::Crypto(full_data_);
 
-		for (int32_t i = 0; i < transaction_env_.signatures_size(); i++) {
-			const protocol::Signature &signature = transaction_env_.signatures(i);
-			PublicKey pubkey(signature.public_key());
+		if (verify_signature) {
+			VerifySignatures(std::vector<TransactionFrm *>(1, this));
+		}
+	}
+
+	void TransactionFrm::VerifySignatures(const std::vector<TransactionFrm *> &tx_frms) {
+		SignatureCache &signature_cache = LedgerManager::Instance().signature_cache_;
 
-			if (!pubkey.IsValid()) {
-				LOG_ERROR("Invalid publickey(%s)", signature.public_key().c_str());
-				continue;
+		//transactions seen before take their signers from the cache
+		std::vector<TransactionFrm *> verify_frms;
+		for (size_t i = 0; i < tx_frms.size(); i++) {
+			if (!signature_cache.Get(tx_frms[i]->full_hash_, tx_frms[i]->valid_signature_)) {
+				verify_frms.push_back(tx_frms[i]);
 			}
-			if (!PublicKey::Verify(data_, signature.sign_data(), signature.public_key())) {
-				LOG_ERROR("Invalid signature data(%s)", utils::String::BinToHexString(signature.SerializeAsString()).c_str());
-				continue;
+		}
+
+		std::vector<SignatureEntry> entries;
+		for (size_t i = 0; i < verify_frms.size(); i++) {
+			TransactionFrm *tx_frm = verify_frms[i];
+			for (int32_t j = 0; j < tx_frm->transaction_env_.signatures_size(); j++) {
+				const protocol::Signature &signature = tx_frm->transaction_env_.signatures(j);
+				entries.push_back(SignatureEntry(tx_frm->data_, signature.sign_data(), signature.public_key()));
+			}
+		}
+
+		std::vector<bool> valid;
+		PublicKey::VerifyGroup(entries, valid);
+
+		size_t index = 0;
+		for (size_t i = 0; i < verify_frms.size(); i++) {
+			TransactionFrm *tx_frm = verify_frms[i];
+			for (int32_t j = 0; j < tx_frm->transaction_env_.signatures_size(); j++, index++) {
+				const protocol::Signature &signature = tx_frm->transaction_env_.signatures(j);
+				PublicKey pubkey(signature.public_key());
+
+				if (!pubkey.IsValid()) {
+					LOG_ERROR("Invalid publickey(%s)", signature.public_key().c_str());
+					continue;
+				}
+				if (!valid[index]) {
+					LOG_ERROR("Invalid signature data(%s)", utils::String::BinToHexString(signature.SerializeAsString()).c_str());
+					continue;
+				}
+				tx_frm->valid_signature_.insert(pubkey.GetEncAddress());
 			}
-			valid_signature_.insert(pubkey.GetEncAddress());
+			signature_cache.Set(tx_frm->full_hash_, tx_frm->valid_signature_);
 		}
 	}
 
@@ -243,6 +276,8 @@ namespace bumo {
 		int64_t fee = GetFeeLimit();
 		std::string str_address = transaction_env_.transaction().source_address();
 		AccountFrm::pointer source_account;
+		//the total is changed only when the fee is paid, a dropped tx adds nothing to it
+		int64_t new_total_fee = 0;
 
 		do {
 			if (!environment->GetEntry(str_address, source_account)) {
@@ -251,7 +286,7 @@ namespace bumo {
 				break;
 			}
 
-			if (!utils::SafeIntAdd(total_fee, fee, total_fee)){
+			if (!utils::SafeIntAdd(total_fee, fee, new_total_fee)){
 				LOG_ERROR("Source account(%s), fee overflow (" FMT_I64 ") (" FMT_I64 ")", 
 					str_address.c_str(), total_fee, fee);
 				result_.set_code(protocol::ERRCODE_MATH_OVERFLOW);
@@ -267,6 +302,7 @@ namespace bumo {
 			}
 
 			proto_source_account.set_balance(new_balance);
+			total_fee = new_total_fee;
 
 			LOG_INFO("Account(%s) paid(" FMT_I64 ") on Tx(%s) and the latest balance(" FMT_I64 ")", str_address.c_str(), fee, utils::String::BinToHexString(hash_).c_str(), new_balance);
 
@@ -793,6 +829,31 @@ namespace bumo {
 		return bSucess;
 	}
 
+	void TransactionFrm::ToJournal(JournalEntry &entry, bool applied) {
+		entry.result_ = result_;
+		entry.actual_gas_ = actual_gas_;
+		entry.instructions_ = instructions_;
+
+		//the changes of a failed transaction are discarded
+		if (applied) {
+			JournalEntry::CopyAccounts(environment_->GetActionBuf(), entry.accounts_);
+			JournalEntry::CopySettings(environment_->settings_.GetActionBuf(), entry.settings_);
+		}
+	}
+
+	bool TransactionFrm::ApplyJournal(LedgerFrm* ledger_frm, std::shared_ptr<Environment> parent, const JournalEntry &entry) {
+		ledger_ = ledger_frm;
+		environment_ = parent;
+
+		result_ = entry.result_;
+		actual_gas_ = entry.actual_gas_;
+		instructions_ = entry.instructions_;
+
+		JournalEntry::CopyAccounts(entry.accounts_, environment_->GetActionBuf());
+		JournalEntry::CopySettings(entry.settings_, environment_->settings_.GetActionBuf());
+		return result_.code() == protocol::ERRCODE_SUCCESS;
+	}
+
 	void TransactionFrm::ApplyExpireResult() // for sync node
 	{
 		result_.set_code(protocol::ERRCODE_CONTRACT_EXECUTE_EXPIRED);
@@ -31,6 +31,7 @@ namespace bumo {
 	class OperationFrm;
 	class AccountEntry;
 	class LedgerFrm;
+	class JournalEntry;
 	class TransactionFrm {
 	public:
 		typedef std::shared_ptr<bumo::TransactionFrm> pointer;
@@ -41,7 +42,7 @@ namespace bumo {
 	public:
 		//only valid when the transaction belongs to a txset
 		TransactionFrm();
-		TransactionFrm(const protocol::TransactionEnv &env);
+		TransactionFrm(const protocol::TransactionEnv &env, bool verify_signature = true);
 		
 		virtual ~TransactionFrm();
 		
@@ -68,7 +69,10 @@ namespace bumo {
 
 		Result GetResult() const;
 
-		void Initialize();
+		void Initialize(bool verify_signature = true);
+
+		//verify all signatures of the transactions as one group and fill their valid signature sets
+		static void VerifySignatures(const std::vector<TransactionFrm *> &tx_frms);
 
 		uint32_t LoadFromDb(const std::string &hash);
 
@@ -76,6 +80,10 @@ namespace bumo {
 		void NonceIncrease(LedgerFrm* ledger_frm, std::shared_ptr<Environment> env);
 		bool Apply(LedgerFrm* ledger_frm, std::shared_ptr<Environment> env, bool bool_contract = false);
 		bool ApplyExpr(const std::string &code, const std::string &log_prefix);
+		//keep what Apply left in the environment, call it before ReturnFee and Commit
+		void ToJournal(JournalEntry &entry, bool applied);
+		//install the entry recorded on the same state instead of Apply
+		bool ApplyJournal(LedgerFrm* ledger_frm, std::shared_ptr<Environment> parent, const JournalEntry &entry);
 
 		protocol::TransactionEnv &GetProtoTxEnv() {
 			return transaction_env_;
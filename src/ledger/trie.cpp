@@ -13,14 +13,18 @@
 	along with bumo.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
 #include <utils/logger.h>
 #include "utils/strings.h"
 #include "trie.h"
 
 namespace bumo{
 
-	int NodeFrm::NEWCOUNT;
-	int NodeFrm::DELCOUNT;
+	volatile int32_t NodeFrm::NEWCOUNT;
+	volatile int32_t NodeFrm::DELCOUNT;
+	const uint8_t Trie::NODE_FORMAT_COMPACT;
+	const size_t Trie::NODE_CHILD_COUNT;
+	const size_t Trie::FIXED_HASH_SIZE;
 	/*
 	-----------------------------
 	old\new |  add  | mod  | del
@@ -30,14 +34,46 @@ namespace bumo{
 	-----------------------------
 	*/
 
+	NodeChildren::NodeChildren() :mask_(0){}
+
+	int NodeChildren::Index(int branch) const{
+		int index = 0;
+		for (uint16_t bits = mask_ & ((1 << branch) - 1); bits != 0; bits &= bits - 1){
+			index++;
+		}
+		return index;
+	}
+
+	NodeFrm::POINTER NodeChildren::Get(int branch) const{
+		if ((mask_ & (1 << branch)) == 0){
+			return nullptr;
+		}
+		return nodes_[Index(branch)];
+	}
+
+	void NodeChildren::Set(int branch, NodeFrm::POINTER child){
+		int index = Index(branch);
+		if ((mask_ & (1 << branch)) != 0){
+			if (child != nullptr){
+				nodes_[index] = child;
+			}
+			else{
+				nodes_.erase(nodes_.begin() + index);
+				mask_ &= ~(1 << branch);
+			}
+		}
+		else if (child != nullptr){
+			nodes_.insert(nodes_.begin() + index, child);
+			mask_ |= (1 << branch);
+		}
+	}
+
 	NodeFrm::NodeFrm(const Location& location)
 		:leaf_(nullptr),  /*indb_(false),leaf_indb_(false),*/ leaf_deleted_(false), modified_(true), location_(location){
 		for (int i = 0; i <= 16; i++){
-			protocol::Child* ch = info_.add_children();
-			if (i != 16)
-				children_[i] = nullptr;
+			info_.add_children();
 		}
-		NEWCOUNT++;
+		utils::AtomicInc(&NEWCOUNT);
 	}
 
 	void NodeFrm::SetValue(const std::string& v){
@@ -60,13 +96,13 @@ namespace bumo{
 	void NodeFrm::SetChild(int branch, POINTER child){
 		assert(branch < 16);
 		modified_ = true;
-		children_[branch] = child;
+		children_.Set(branch, child);
 		info_.mutable_children(branch)->set_sublocation(child->location_);
 		//info_.mutable_children(branch)->set_childtype();
 	}
 
 	NodeFrm::~NodeFrm(){
-		DELCOUNT++;
+		utils::AtomicInc(&DELCOUNT);
 	}
 
 	Trie::Trie(){
@@ -85,18 +121,19 @@ namespace bumo{
 
 	void Trie::Release(NodeFrm::POINTER node, int depth){
 		for (int i = 0; i < 16; i++){
-			auto child = node->children_[i];
+			auto child = node->children_.Get(i);
 			if (child != nullptr){
 				Release(child, depth - 1);
 				if (depth <= 0){
-					node->children_[i] = nullptr;
+					node->children_.Set(i, nullptr);
 				}
 			}
 		}
 	}
 
 	NodeFrm::POINTER Trie::ChildMayFromDB(NodeFrm::POINTER node, int branch) {
-		if (node->children_[branch] == nullptr){
+		NodeFrm::POINTER child = node->children_.Get(branch);
+		if (child == nullptr){
 			NodeFrm::POINTER frm = nullptr;
 			const protocol::Child& chd = node->info_.children(branch);
 			if (chd.childtype() == protocol::NONE){
@@ -111,13 +148,14 @@ namespace bumo{
 
 			}
 			else if (chd.childtype() == protocol::INNER){
-				if (!storage_load(chd.sublocation(), frm->info_)){
+				if (!storage_load(chd.sublocation(), chd.hash(), frm->info_)){
 					PROCESS_EXIT("load:%s failed", utils::String::BinToHexString(chd.sublocation()).c_str());
 				}
 			}
-			node->children_[branch] = frm;
+			node->children_.Set(branch, frm);
+			child = frm;
 		}
-		return node->children_[branch];
+		return child;
 	}
 
 
@@ -179,7 +217,251 @@ namespace bumo{
 		return location + key;
 	}
 
-	protocol::Child Trie::update_hash(NodeFrm::POINTER node){
+	void Trie::LocationToNibbles(const Location& location, std::vector<uint8_t>& nibbles){
+		nibbles.clear();
+		if (location.empty()){
+			return;
+		}
+
+		size_t count = (location.length() - 1) * 2;
+		if (location.at(0) == ODD_PREFIX && count > 0){
+			count--;
+		}
+		for (size_t i = 0; i < count; i++){
+			uint8_t ch = (uint8_t)location.at(1 + i / 2);
+			nibbles.push_back(i % 2 == 0 ? (ch >> 4) & 0x0f : ch & 0x0f);
+		}
+	}
+
+	Location Trie::NibblesToLocation(const std::vector<uint8_t>& nibbles){
+		Location location = "";
+		location.push_back(nibbles.size() % 2 == 0 ? EVEN_PREFIX : ODD_PREFIX);
+		for (size_t i = 0; i < nibbles.size(); i += 2){
+			uint8_t ch = nibbles[i] << 4;
+			if (i + 1 < nibbles.size()){
+				ch |= nibbles[i + 1];
+			}
+			location.push_back((char)ch);
+		}
+		return location;
+	}
+
+	static void PutVarint(std::string& buff, uint64_t value){
+		while (value >= 0x80){
+			buff.push_back((char)(value | 0x80));
+			value >>= 7;
+		}
+		buff.push_back((char)value);
+	}
+
+	static bool GetVarint(const std::string& buff, size_t& pos, uint64_t& value){
+		value = 0;
+		for (int shift = 0; shift < 64 && pos < buff.size(); shift += 7){
+			uint8_t ch = (uint8_t)buff[pos++];
+			value |= (uint64_t)(ch & 0x7f) << shift;
+			if ((ch & 0x80) == 0){
+				return true;
+			}
+		}
+		return false;
+	}
+
+	static bool GetBytes(const std::string& buff, size_t& pos, size_t size, std::string& value){
+		if (size > buff.size() - pos){
+			return false;
+		}
+		value = buff.substr(pos, size);
+		pos += size;
+		return true;
+	}
+
+	/*
+	compact node, version 1
+	-----------------------------
+	version      | 1 byte
+	bitmap       | 3 bytes, bit i for the child i present
+	children     | for each present child
+	  flags      | 1 byte, bits 0-1 childtype, bit 2 fixed hash, bit 3 relative location
+	  location   | relative: nothing for the leaf of the node, or the count of the nibbles
+	             |   after the parent's location and the branch, then the nibbles packed
+	             | otherwise: length, then the location
+	  hash       | fixed: 32 bytes, otherwise: length, then the hash
+	-----------------------------
+	*/
+	std::string Trie::EncodeNode(const Location& location, const protocol::Node& info){
+		const uint8_t fixed_hash = 0x04;
+		const uint8_t relative = 0x08;
+
+		if ((size_t)info.children_size() != NODE_CHILD_COUNT){
+			return info.SerializeAsString();
+		}
+
+		uint32_t bitmap = 0;
+		for (size_t i = 0; i < NODE_CHILD_COUNT; i++){
+			const protocol::Child& chd = info.children(i);
+			if (chd.childtype() < protocol::NONE || chd.childtype() > protocol::LEAF){
+				return info.SerializeAsString();
+			}
+			if (chd.childtype() != protocol::NONE || !chd.sublocation().empty() || !chd.hash().empty()){
+				bitmap |= (1 << i);
+			}
+		}
+
+		std::vector<uint8_t> parent;
+		LocationToNibbles(location, parent);
+
+		std::string buff;
+		buff.push_back((char)NODE_FORMAT_COMPACT);
+		buff.push_back((char)(bitmap & 0xff));
+		buff.push_back((char)((bitmap >> 8) & 0xff));
+		buff.push_back((char)((bitmap >> 16) & 0xff));
+		for (size_t i = 0; i < NODE_CHILD_COUNT; i++){
+			if ((bitmap & (1 << i)) == 0){
+				continue;
+			}
+
+			const protocol::Child& chd = info.children(i);
+			uint8_t flags = (uint8_t)chd.childtype();
+			if (chd.hash().size() == FIXED_HASH_SIZE){
+				flags |= fixed_hash;
+			}
+
+			//a child is below the parent on its branch, only the nibbles after that are kept
+			std::string path;
+			if (i == 16){
+				if (chd.sublocation() == location){
+					flags |= relative;
+				}
+			}
+			else{
+				std::vector<uint8_t> nibbles;
+				LocationToNibbles(chd.sublocation(), nibbles);
+				if (nibbles.size() > parent.size() && nibbles[parent.size()] == i &&
+					std::equal(parent.begin(), parent.end(), nibbles.begin()) &&
+					NibblesToLocation(nibbles) == chd.sublocation()){
+					flags |= relative;
+					std::vector<uint8_t> rest(nibbles.begin() + parent.size() + 1, nibbles.end());
+					PutVarint(path, rest.size());
+					for (size_t j = 0; j < rest.size(); j += 2){
+						path.push_back((char)((rest[j] << 4) | (j + 1 < rest.size() ? rest[j + 1] : 0)));
+					}
+				}
+			}
+
+			buff.push_back((char)flags);
+			if ((flags & relative) != 0){
+				buff += path;
+			}
+			else{
+				PutVarint(buff, chd.sublocation().size());
+				buff += chd.sublocation();
+			}
+
+			if ((flags & fixed_hash) == 0){
+				PutVarint(buff, chd.hash().size());
+			}
+			buff += chd.hash();
+		}
+		return buff;
+	}
+
+	bool Trie::DecodeNode(const Location& location, const std::string& buff, protocol::Node& info){
+		const uint8_t fixed_hash = 0x04;
+		const uint8_t relative = 0x08;
+
+		//a protobuf node starts with the tag of the children
+		if (buff.empty() || (uint8_t)buff[0] != NODE_FORMAT_COMPACT){
+			return info.ParseFromString(buff);
+		}
+
+		if (buff.size() < 4){
+			return false;
+		}
+		uint32_t bitmap = (uint8_t)buff[1] | ((uint8_t)buff[2] << 8) | ((uint8_t)buff[3] << 16);
+
+		std::vector<uint8_t> parent;
+		LocationToNibbles(location, parent);
+
+		info.Clear();
+		size_t pos = 4;
+		for (size_t i = 0; i < NODE_CHILD_COUNT; i++){
+			protocol::Child* chd = info.add_children();
+			if ((bitmap & (1 << i)) == 0){
+				continue;
+			}
+
+			if (pos >= buff.size()){
+				return false;
+			}
+			uint8_t flags = (uint8_t)buff[pos++];
+			chd->set_childtype((protocol::CHILDTYPE)(flags & 0x03));
+
+			uint64_t size = 0;
+			if ((flags & relative) != 0 && i == 16){
+				chd->set_sublocation(location);
+			}
+			else if ((flags & relative) != 0){
+				std::string packed;
+				if (!GetVarint(buff, pos, size) || !GetBytes(buff, pos, (size + 1) / 2, packed)){
+					return false;
+				}
+				std::vector<uint8_t> nibbles = parent;
+				nibbles.push_back((uint8_t)i);
+				for (size_t j = 0; j < size; j++){
+					uint8_t ch = (uint8_t)packed[j / 2];
+					nibbles.push_back(j % 2 == 0 ? (ch >> 4) & 0x0f : ch & 0x0f);
+				}
+				chd->set_sublocation(NibblesToLocation(nibbles));
+			}
+			else{
+				std::string sublocation;
+				if (!GetVarint(buff, pos, size) || !GetBytes(buff, pos, size, sublocation)){
+					return false;
+				}
+				chd->set_sublocation(sublocation);
+			}
+
+			std::string hash;
+			if ((flags & fixed_hash) != 0){
+				size = FIXED_HASH_SIZE;
+			}
+			else if (!GetVarint(buff, pos, size)){
+				return false;
+			}
+			if (!GetBytes(buff, pos, size, hash)){
+				return false;
+			}
+			chd->set_hash(hash);
+		}
+		return pos == buff.size();
+	}
+
+	void Trie::Store(StorageOps *ops, StorageOp::Type type, NodeFrm::POINTER node){
+		if (ops != nullptr){
+			StorageOp op;
+			op.type_ = type;
+			op.node_ = node;
+			ops->push_back(op);
+			return;
+		}
+
+		switch (type){
+		case StorageOp::SAVE_NODE:
+			StorageSaveNode(node);
+			break;
+		case StorageOp::SAVE_LEAF:
+			StorageSaveLeaf(node);
+			break;
+		case StorageOp::DELETE_NODE:
+			StorageDeleteNode(node);
+			break;
+		case StorageOp::DELETE_LEAF:
+			StorageDeleteLeaf(node);
+			break;
+		}
+	}
+
+	protocol::Child Trie::update_hash(NodeFrm::POINTER node, StorageOps *ops, const HashJobMap *jobs){
 
 		int branch_count = 0;
 		int onlybranch = -1;
@@ -195,13 +477,13 @@ namespace bumo{
 				this_child->set_sublocation(node->location_);
 				this_child->set_hash(HashCrypto(*(node->leaf_)));
 				this_child->set_childtype(protocol::LEAF);
-				StorageSaveLeaf(node);
+				Store(ops, StorageOp::SAVE_LEAF, node);
 			}
 		}
 		else{
 			protocol::Child* ch = node->info_.mutable_children(16);
 			ch->Clear();
-			StorageDeleteLeaf(node);
+			Store(ops, StorageOp::DELETE_LEAF, node);
 		}
 
 		if (node->info_.children(16).childtype() != protocol::CHILDTYPE::NONE){
@@ -211,9 +493,16 @@ namespace bumo{
 		}
 
 		for (int i = 0; i < 16; i++){
-			NodeFrm::POINTER child = node->children_[i];
-			if ((child != nullptr) && (child->modified_)){
-				protocol::Child childresult = update_hash(child);
+			NodeFrm::POINTER child = node->children_.Get(i);
+			HashJobMap::const_iterator job;
+			if ((child != nullptr) && jobs != nullptr && (job = jobs->find(child.get())) != jobs->end()){
+				node->info_.mutable_children(i)->CopyFrom(job->second->result_);
+				for (size_t j = 0; j < job->second->ops_.size(); j++){
+					Store(ops, job->second->ops_[j].type_, job->second->ops_[j].node_);
+				}
+			}
+			else if ((child != nullptr) && (child->modified_)){
+				protocol::Child childresult = update_hash(child, ops, jobs);
 				node->info_.mutable_children(i)->CopyFrom(childresult);
 			}
 
@@ -235,16 +524,16 @@ namespace bumo{
 		result.set_count(children_count);
 #endif		
 		if (branch_count == 0 && node->location_ != rootl){
-			StorageDeleteNode(node);
+			Store(ops, StorageOp::DELETE_NODE, node);
 			//node->indb_ = false;
 		}
 		else if (branch_count == 1 && node->location_ != rootl){
-			StorageDeleteNode(node);
+			Store(ops, StorageOp::DELETE_NODE, node);
 			//node->indb_ = false;
 			result.CopyFrom(node->info_.children(onlybranch));
 		}
 		else {
-			StorageSaveNode(node);
+			Store(ops, StorageOp::SAVE_NODE, node);
 			result.set_hash(HashCrypto(node->info_.SerializeAsString()));
 			result.set_sublocation(node->location_);
 			result.set_childtype(protocol::CHILDTYPE::INNER);
@@ -369,7 +658,7 @@ namespace bumo{
 
 	void Trie::GetAllItem(const Location& node, const Location& location, std::vector<std::string>& result){
 		protocol::Node info;
-		if (!storage_load(node, info)){
+		if (!storage_load(node, "", info)){
 			return;
 		}
 		Location common = CommonPrefix(node, location);
@@ -432,7 +721,69 @@ namespace bumo{
 	}
 
 	void Trie::UpdateHash(){
-		root_hash_ = update_hash(root_).hash();
+		root_hash_ = update_hash(root_, nullptr, nullptr).hash();
+	}
+
+	void Trie::UpdateHash(utils::ThreadPool *pool){
+		//subtrees with fewer modified nodes are not worth a job
+		const int64_t min_job_nodes = 32;
+
+		ModifiedCountMap counts;
+		int64_t total = CountModified(root_, counts);
+		if (pool == nullptr || pool->Size() <= 1 || total < 2 * min_job_nodes){
+			UpdateHash();
+			return;
+		}
+
+		//a few jobs per worker to balance the uneven subtrees
+		int64_t grain = MAX(min_job_nodes, total / (int64_t)(pool->Size() * 4));
+		std::vector<HashJob> jobs;
+		SelectHashJobs(root_, grain, counts, jobs);
+
+		HashJobMap job_map;
+		std::vector<utils::ThreadCallback> callbacks;
+		for (size_t i = 0; i < jobs.size(); i++){
+			HashJob *job = &jobs[i];
+			job_map[job->node_.get()] = job;
+			callbacks.push_back([this, job]() {
+				job->result_ = update_hash(job->node_, &job->ops_, nullptr);
+			});
+		}
+		pool->Execute(callbacks);
+
+		//hash the nodes above the jobs, and write the storage in the same order as the serial version
+		root_hash_ = update_hash(root_, nullptr, &job_map).hash();
+	}
+
+	int64_t Trie::CountModified(NodeFrm::POINTER node, ModifiedCountMap& counts){
+		int64_t count = 1;
+		for (int i = 0; i < 16; i++){
+			NodeFrm::POINTER child = node->children_.Get(i);
+			if ((child != nullptr) && (child->modified_)){
+				count += CountModified(child, counts);
+			}
+		}
+		counts[node.get()] = count;
+		return count;
+	}
+
+	void Trie::SelectHashJobs(NodeFrm::POINTER node, int64_t grain, const ModifiedCountMap& counts, std::vector<HashJob>& jobs){
+		for (int i = 0; i < 16; i++){
+			NodeFrm::POINTER child = node->children_.Get(i);
+			if ((child == nullptr) || (!child->modified_)){
+				continue;
+			}
+
+			int64_t count = counts.find(child.get())->second;
+			if (count > grain){
+				SelectHashJobs(child, grain, counts, jobs);
+			}
+			else if (count * 2 >= grain){
+				HashJob job;
+				job.node_ = child;
+				jobs.push_back(job);
+			}
+		}
 	}
 
 	bool Trie::Delete(const std::string& key){
@@ -443,7 +794,7 @@ namespace bumo{
 
 	void Trie::StorageAssociated(const Location& location, std::vector<std::string>& result){
 		protocol::Node info;
-		if (!storage_load(location, info)){
+		if (!storage_load(location, "", info)){
 			return;
 		}
 		if (info.children(16).childtype() == protocol::CHILDTYPE::LEAF){
@@ -16,18 +16,38 @@
 #ifndef TRIE_H_
 #define TRIE_H_
 
+#include <unordered_map>
 #include <utils/sm3.h>
+#include <utils/thread.h>
 #include "proto/cpp/merkeltrie.pb.h"
 
 namespace bumo{
 	typedef std::string Location;
 	typedef std::string HASH;
 
+	class NodeFrm;
+
+	//the loaded children of a node, kept by branch in a mask and a dense vector,
+	//most nodes have none or a few of the 16 children in memory
+	class NodeChildren{
+	public:
+		NodeChildren();
+
+		std::shared_ptr<NodeFrm> Get(int branch) const;
+		//nullptr unloads the child
+		void Set(int branch, std::shared_ptr<NodeFrm> child);
+	private:
+		int Index(int branch) const;
+
+		uint16_t mask_;
+		std::vector<std::shared_ptr<NodeFrm>> nodes_;
+	};
+
 	class NodeFrm{
 	public:
 		typedef std::shared_ptr<NodeFrm> POINTER;
 		Location location_;
-		POINTER children_[16];
+		NodeChildren children_;
 		
 		protocol::Node info_;
 		
@@ -35,8 +55,8 @@ namespace bumo{
 		bool leaf_deleted_;
 		std::shared_ptr<std::string> leaf_;//nullptr default
 
-		static int NEWCOUNT;
-		static int DELCOUNT;
+		static volatile int32_t NEWCOUNT;
+		static volatile int32_t DELCOUNT;
 	public:
 		NodeFrm(const Location& location);
 
@@ -49,10 +69,30 @@ namespace bumo{
 
 	class Trie
 	{
+		//a storage write of update_hash, recorded by the parallel jobs and replayed in serial order
+		struct StorageOp{
+			enum Type{ SAVE_NODE, SAVE_LEAF, DELETE_NODE, DELETE_LEAF };
+			Type type_;
+			NodeFrm::POINTER node_;
+		};
+		typedef std::vector<StorageOp> StorageOps;
+
+		//a modified subtree hashed on the pool
+		struct HashJob{
+			NodeFrm::POINTER node_;
+			protocol::Child result_;
+			StorageOps ops_;
+		};
+		typedef std::unordered_map<NodeFrm*, HashJob*> HashJobMap;
+		typedef std::unordered_map<NodeFrm*, int64_t> ModifiedCountMap;
 
 		bool SetItem(NodeFrm::POINTER node, const Location &key, const std::string &value, int depth);
 		bool DeleteItem(NodeFrm::POINTER node, const Location& key);
-		protocol::Child update_hash(NodeFrm::POINTER node);
+		protocol::Child update_hash(NodeFrm::POINTER node, StorageOps *ops, const HashJobMap *jobs);
+		void Store(StorageOps *ops, StorageOp::Type type, NodeFrm::POINTER node);
+
+		int64_t CountModified(NodeFrm::POINTER node, ModifiedCountMap& counts);
+		void SelectHashJobs(NodeFrm::POINTER node, int64_t grain, const ModifiedCountMap& counts, std::vector<HashJob>& jobs);
 
 		void Release(NodeFrm::POINTER node, int depth);
 		
@@ -64,7 +104,8 @@ namespace bumo{
 		Location rootl ;
 		NodeFrm::POINTER ChildMayFromDB(NodeFrm::POINTER node, int branch);
 
-		virtual bool storage_load(const Location& location, protocol::Node& info) = 0;
+		//hash is the expected hash of the node, empty if unknown
+		virtual bool storage_load(const Location& location, const HASH& hash, protocol::Node& info) = 0;
 
 		virtual void StorageSaveNode(NodeFrm::POINTER node) = 0;
 		virtual void StorageSaveLeaf(NodeFrm::POINTER node) = 0;
@@ -102,6 +143,9 @@ namespace bumo{
 
 		void UpdateHash();
 
+		//hash the large modified subtrees on the pool, the result and the storage writes are the same as UpdateHash()
+		void UpdateHash(utils::ThreadPool *pool);
+
 		void FreeMemory(int depth);
 	
 		protocol::Node GetNode(const Location& key);
@@ -110,6 +154,21 @@ namespace bumo{
 		static Location CommonPrefix(const Location& s1, const Location& s2);
 		static int NextBranch(const Location &s1, const Location& s2);
 		static Location Key2Location(const std::string& key);
+
+		//the stored form of a node. the hash of a node is always taken on the protobuf
+		//serialization, the storage uses a compact encoding with a child bitmap, fixed size
+		//hashes and the locations packed as the nibbles after the parent's location.
+		//a node the compact encoding can't hold exactly is stored as protobuf
+		static std::string EncodeNode(const Location& location, const protocol::Node& info);
+		//both encodings are accepted
+		static bool DecodeNode(const Location& location, const std::string& buff, protocol::Node& info);
+	private:
+		static const uint8_t NODE_FORMAT_COMPACT = 0x01;
+		static const size_t NODE_CHILD_COUNT = 17;
+		static const size_t FIXED_HASH_SIZE = 32;
+
+		static void LocationToNibbles(const Location& location, std::vector<uint8_t>& nibbles);
+		static Location NibblesToLocation(const std::vector<uint8_t>& nibbles);
 	};
 }
 
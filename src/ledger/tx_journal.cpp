@@ -0,0 +1,54 @@
+/*
+	bumo is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	bumo is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with bumo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "tx_journal.h"
+
+namespace bumo {
+	JournalEntry::JournalEntry() :
+		actual_gas_(0) {}
+
+	JournalEntry::~JournalEntry() {}
+
+	void JournalEntry::CopyAccounts(const Environment::mapKV &from, Environment::mapKV &to) {
+		for (auto it = from.begin(); it != from.end(); it++) {
+			Environment::pointer value = nullptr;
+			if (it->second.value_ != nullptr) {
+				value = std::make_shared<AccountFrm>(*(it->second.value_));
+			}
+			to[it->first] = Environment::ActValue(value, it->second.type_);
+		}
+	}
+
+	void JournalEntry::CopySettings(const Environment::settingKV &from, Environment::settingKV &to) {
+		for (auto it = from.begin(); it != from.end(); it++) {
+			std::shared_ptr<Json::Value> value = nullptr;
+			if (it->second.value_ != nullptr) {
+				value = std::make_shared<Json::Value>(*(it->second.value_));
+			}
+			to[it->first] = AtomMap<std::string, Json::Value>::ActValue(value, it->second.type_);
+		}
+	}
+
+	std::string TransactionJournal::BaseKey(const protocol::ConsensusValue &value) {
+		//the contracts read the sequence and the close time of the value
+		return HashWrapper::Crypto(value.previous_ledger_hash() +
+			utils::String::ToString(value.ledger_seq()) + "-" +
+			utils::String::ToString(value.close_time()));
+	}
+
+	std::string TransactionJournal::NextKey(const std::string &key, const std::string &full_hash, bool expired) {
+		return HashWrapper::Crypto(key + full_hash + (expired ? "1" : "0"));
+	}
+}
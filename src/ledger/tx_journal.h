@@ -0,0 +1,61 @@
+/*
+	bumo is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	bumo is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with bumo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TX_JOURNAL_H_
+#define TX_JOURNAL_H_
+
+#include <utils/counted_lru_cache.h>
+#include <common/general.h>
+#include <proto/cpp/chain.pb.h>
+#include <proto/cpp/consensus.pb.h>
+#include <json/json.h>
+#include "environment.h"
+
+namespace bumo {
+
+	//what a transaction left in the environment when it was applied
+	class JournalEntry {
+	public:
+		typedef std::shared_ptr<JournalEntry> pointer;
+
+		JournalEntry();
+		~JournalEntry();
+
+		Result result_;
+		int64_t actual_gas_;
+		std::vector<protocol::TransactionEnvStore> instructions_;
+		//the accounts and settings the transaction read or wrote, in the state after it
+		Environment::mapKV accounts_;
+		Environment::settingKV settings_;
+
+		//deep copy of a change buffer, the copies can't be shared with a live environment
+		static void CopyAccounts(const Environment::mapKV &from, Environment::mapKV &to);
+		static void CopySettings(const Environment::settingKV &from, Environment::settingKV &to);
+	};
+
+	//results of the transactions applied recently, so a node applying the same
+	//prefix of a value again replays the state changes instead of running the contracts.
+	//the key of a transaction chains the key of the value with the hashes of the
+	//transactions applied before it, so a hit means the state before it is the same
+	class TransactionJournal : public utils::CountedLruCache<std::string, JournalEntry::pointer> {
+	public:
+		//key of the state before the first transaction of the value
+		static std::string BaseKey(const protocol::ConsensusValue &value);
+		//key of the state after the transaction, an expired transaction leaves another state
+		static std::string NextKey(const std::string &key, const std::string &full_hash, bool expired);
+	};
+}
+
+#endif
@@ -122,6 +122,17 @@ namespace bumo {
 		hash_type_ = 0; // 0 : SHA256, 1 :SM2
 		queue_limit_ = 10240;
 		queue_per_account_txs_limit_ = 64;
+		worker_thread_count_ = 0; // 0 : cpu core count
+		signature_cache_size_ = 20480; // 0 : disabled
+		trie_node_cache_size_ = 65536; // 0 : disabled
+		tx_journal_size_ = 10240; // 0 : disabled
+		account_cache_size_ = 10240; // 0 : disabled
+		contract_code_cache_size_ = 1024; // 0 : disabled
+		contract_code_cache_persist_ = false;
+		contract_query_cache_size_ = 1024; // 0 : disabled
+		contract_query_thread_count_ = 0; // 0 : cpu core count
+		process_thread_count_ = 2; // 0 : cpu core count
+		parallel_execute_ = false;
 	}
 
 	LedgerConfigure::~LedgerConfigure() {
@@ -138,6 +149,17 @@ namespace bumo {
 		Configure::GetValue(value, "max_trans_in_memory", max_trans_in_memory_);
 		Configure::GetValue(value, "hardfork_points", hardfork_points_);
 		Configure::GetValue(value, "use_atom_map", use_atom_map_);
+		Configure::GetValue(value, "worker_thread_count", worker_thread_count_);
+		Configure::GetValue(value, "signature_cache_size", signature_cache_size_);
+		Configure::GetValue(value, "trie_node_cache_size", trie_node_cache_size_);
+		Configure::GetValue(value, "tx_journal_size", tx_journal_size_);
+		Configure::GetValue(value, "account_cache_size", account_cache_size_);
+		Configure::GetValue(value, "contract_code_cache_size", contract_code_cache_size_);
+		Configure::GetValue(value, "contract_code_cache_persist", contract_code_cache_persist_);
+		Configure::GetValue(value, "contract_query_cache_size", contract_query_cache_size_);
+		Configure::GetValue(value, "contract_query_thread_count", contract_query_thread_count_);
+		Configure::GetValue(value, "process_thread_count", process_thread_count_);
+		Configure::GetValue(value, "parallel_execute", parallel_execute_);
 
 		Configure::GetValue(value["tx_pool"], "queue_limit", queue_limit_);
         Configure::GetValue(value["tx_pool"], "queue_per_account_txs_limit", queue_per_account_txs_limit_);
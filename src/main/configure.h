@@ -90,6 +90,17 @@ namespace bumo {
 		uint32_t queue_per_account_txs_limit_;
 		utils::StringList hardfork_points_;
 		bool use_atom_map_;
+		uint32_t worker_thread_count_;
+		uint32_t signature_cache_size_;
+		uint32_t trie_node_cache_size_;
+		uint32_t tx_journal_size_;
+		uint32_t account_cache_size_;
+		uint32_t contract_code_cache_size_;
+		bool contract_code_cache_persist_;
+		uint32_t contract_query_cache_size_;
+		uint32_t contract_query_thread_count_;
+		uint32_t process_thread_count_;
+		bool parallel_execute_;
 		bool Load(const Json::Value &value);
 	};
 
@@ -2,6 +2,7 @@
 #define TEMPLATE_ATOMIC_MAP_H
 
 #include <map>
+#include <vector>
 #include <string>
 #include <memory>
 #include <exception>
@@ -180,24 +181,45 @@ namespace bumo
 		}
 
 	private:
-		bool CopyCommit()
+		//write the changes into data_ in place, the cost is the number of changed keys,
+		//the replaced values are kept to restore data_ if the commit throws
+		bool JournalCommit()
 		{
-			mapKV copyBuf = *data_;
+			std::vector<std::pair<typename mapKV::iterator, ActValue>> replaced;
+			std::vector<typename mapKV::iterator> inserted;
 			try
 			{
-				for (auto act : actionBuf_)
-					copyBuf[act.first] = act.second;
+				//reserved first, the push_back below never throws
+				replaced.reserve(actionBuf_.size());
+				inserted.reserve(actionBuf_.size());
+
+				for (auto act = actionBuf_.begin(); act != actionBuf_.end(); act++)
+				{
+					auto ret = data_->insert(*act);
+					if (ret.second)
+					{
+						inserted.push_back(ret.first);
+					}
+					else
+					{
+						replaced.push_back(std::make_pair(ret.first, ret.first->second));
+						ret.first->second = act->second;
+					}
+				}
 			}
 			catch (std::exception& e)
 			{
-				LOG_ERROR("copy commit exception, detail: %s", e.what());
+				LOG_ERROR("journal commit exception, detail: %s", e.what());
+				for (auto it = replaced.begin(); it != replaced.end(); it++)
+					it->first->second = it->second;
+				for (auto it = inserted.begin(); it != inserted.end(); it++)
+					data_->erase(*it);
+
 				actionBuf_.clear();
 				return false;
 			}
 
-			data_->swap(copyBuf);
-
-			//CAUTION: now the pointers in actionBuf_ and dataCopy_ are overlapped with data_,
+			//CAUTION: now the pointers in actionBuf_ are overlapped with data_,
 			//so must be clear, otherwise the later modification to them will aslo directly act on data_.
 			actionBuf_.clear(); 
 			return true;
@@ -206,7 +228,7 @@ namespace bumo
 	public:
 		bool Commit()
 		{
-			return CopyCommit();
+			return JournalCommit();
 		}
 
 		//call ClearChange to discard the modification if Commit failed
@@ -0,0 +1,174 @@
+﻿/*
+	bumo is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	bumo is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with bumo.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef UTILS_COUNTED_LRU_CACHE_H_
+#define UTILS_COUNTED_LRU_CACHE_H_
+
+#include <vector>
+#include "thread.h"
+#include "lrucache.hpp"
+
+namespace utils {
+
+	//an lru cache shared by threads, with its hits and misses counted for the module status.
+	//capacity 0 disables it, then nothing is kept and nothing is counted.
+	//the version is for the caches of a ledger state, an entry is got or set only with the
+	//version of the cache, so a reader that started before the state changed misses
+	template<typename key_t, typename value_t>
+	class CountedLruCache {
+	public:
+		typedef std::pair<key_t, value_t> Item;
+
+		CountedLruCache() :
+			capacity_(0),
+			version_(0),
+			hit_count_(0),
+			miss_count_(0) {}
+		~CountedLruCache() {}
+
+		void Initialize(size_t capacity) {
+			MutexGuard guard(mutex_);
+			capacity_ = capacity;
+			if (capacity > 0) {
+				cache_ = std::make_shared<cache::lru_cache<key_t, value_t>>(capacity);
+			}
+			else {
+				cache_ = nullptr;
+			}
+		}
+
+		bool Enabled() {
+			MutexGuard guard(mutex_);
+			return cache_ != nullptr;
+		}
+
+		bool Get(const key_t &key, value_t &value) {
+			MutexGuard guard(mutex_);
+			return GetLocked(key, value);
+		}
+
+		bool Get(const key_t &key, int64_t version, value_t &value) {
+			MutexGuard guard(mutex_);
+			if (version != version_) {
+				return false;
+			}
+			return GetLocked(key, value);
+		}
+
+		//the key dropped to make room is set to evicted, return false if nothing was dropped
+		bool Set(const key_t &key, const value_t &value, key_t *evicted = NULL) {
+			MutexGuard guard(mutex_);
+			return SetLocked(key, value, evicted);
+		}
+
+		bool Set(const key_t &key, int64_t version, const value_t &value, key_t *evicted = NULL) {
+			MutexGuard guard(mutex_);
+			if (version != version_) {
+				return false;
+			}
+			return SetLocked(key, value, evicted);
+		}
+
+		void Erase(const key_t &key) {
+			MutexGuard guard(mutex_);
+			if (cache_ != nullptr) {
+				cache_->erase_if_exists(key);
+			}
+		}
+
+		void Clear() {
+			MutexGuard guard(mutex_);
+			if (cache_ != nullptr) {
+				cache_->clear();
+			}
+		}
+
+		//drop all the entries, the state is of the version now
+		void Reset(int64_t version) {
+			MutexGuard guard(mutex_);
+			if (cache_ != nullptr) {
+				cache_->clear();
+			}
+			version_ = version;
+		}
+
+		//the state moves to the version with the items changed, the other entries are kept
+		void Update(int64_t version, const std::vector<Item> &items) {
+			MutexGuard guard(mutex_);
+			version_ = version;
+			for (size_t i = 0; i < items.size(); i++) {
+				SetLocked(items[i].first, items[i].second, NULL);
+			}
+		}
+
+		int64_t GetVersion() {
+			MutexGuard guard(mutex_);
+			return version_;
+		}
+
+		template<typename json_t>
+		void GetModuleStatus(json_t &data) {
+			MutexGuard guard(mutex_);
+			int64_t total = hit_count_ + miss_count_;
+			data["enabled"] = cache_ != nullptr;
+			data["size"] = (typename json_t::UInt64)(cache_ != nullptr ? cache_->size() : 0);
+			data["hit_count"] = (typename json_t::Int64)hit_count_;
+			data["miss_count"] = (typename json_t::Int64)miss_count_;
+			data["hit_rate"] = total > 0 ? (double)hit_count_ / total : 0.0;
+		}
+
+	private:
+		bool GetLocked(const key_t &key, value_t &value) {
+			if (cache_ == nullptr) {
+				return false;
+			}
+
+			if (!cache_->get(key, value)) {
+				miss_count_++;
+				return false;
+			}
+
+			hit_count_++;
+			return true;
+		}
+
+		bool SetLocked(const key_t &key, const value_t &value, key_t *evicted) {
+			if (cache_ == nullptr) {
+				return false;
+			}
+
+			//the least recently used entry is dropped when the cache is full
+			bool full = cache_->size() >= capacity_ && !cache_->exists(key);
+			key_t last;
+			if (full) {
+				last = cache_->GetList().back().first;
+			}
+			cache_->put(key, value);
+			if (full && evicted != NULL) {
+				*evicted = last;
+			}
+			return full;
+		}
+
+		Mutex mutex_;
+		std::shared_ptr<cache::lru_cache<key_t, value_t>> cache_;
+		size_t capacity_;
+		int64_t version_;
+		int64_t hit_count_;
+		int64_t miss_count_;
+	};
+}
+
+#endif
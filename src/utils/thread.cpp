@@ -19,6 +19,7 @@
 #include <semaphore.h>
 #endif
 
+#include <exception>
 #include "strings.h"
 #include "thread.h"
 
@@ -332,6 +333,7 @@ int utils::ThreadTaskQueue::PutFront(Runnable *task) {
 	if (task) tasks_.push_front(task);
 	ret = tasks_.size();
 	spinLock_.Unlock();
+	if (task) sem_.Signal();
 	return ret;
 }
 
@@ -341,6 +343,7 @@ int utils::ThreadTaskQueue::Put(Runnable *task) {
 	if (task) tasks_.push_back(task);
 	ret = tasks_.size();
 	spinLock_.Unlock();
+	if (task) sem_.Signal();
 	return ret;
 }
 
@@ -364,6 +367,14 @@ utils::Runnable *utils::ThreadTaskQueue::Get() {
 	return task;
 }
 
+void utils::ThreadTaskQueue::Wait() {
+	sem_.Wait();
+}
+
+void utils::ThreadTaskQueue::Wake() {
+	sem_.Signal();
+}
+
 utils::ThreadPool::ThreadPool() : enabled_(false) {}
 
 utils::ThreadPool::~ThreadPool() {
@@ -380,23 +391,39 @@ bool utils::ThreadPool::Init(const std::string &name, int threadNum) {
 
 bool utils::ThreadPool::Exit() {
 	enabled_ = false;
+	for (size_t i = 0; i < threads_.size(); i++) {
+		tasks_.Wake();
+	}
 	for (size_t i = 0; i < threads_.size(); i++) {
 		if (threads_[i]) threads_[i]->JoinWithStop();
 	}
 
+	DrainTasks();
 	return true;
 }
 
+void utils::ThreadPool::DrainTasks() {
+	//the tasks left are run here, they free themselves or wake the waiting callers
+	Runnable *task = NULL;
+	while ((task = tasks_.Get()) != NULL) {
+		task->Run(NULL);
+	}
+}
+
 void utils::ThreadPool::AddTask(Runnable *task) {
 	tasks_.Put(task);
 }
 
 void utils::ThreadPool::JoinwWithStop() {
 	enabled_ = false;
+	for (size_t i = 0; i < threads_.size(); i++) {
+		tasks_.Wake();
+	}
 	for (ThreadVector::const_iterator it = threads_.begin(); it != threads_.end(); ++it) {
 		(*it)->JoinWithStop();
 	}
 	threads_.clear();
+	DrainTasks();
 }
 
 bool utils::ThreadPool::WaitAndJoin() {
@@ -405,6 +432,9 @@ bool utils::ThreadPool::WaitAndJoin() {
 		Sleep(1);
 
 	enabled_ = false;
+	for (size_t i = 0; i < threads_.size(); i++) {
+		tasks_.Wake();
+	}
 	for (size_t i = 0; i < threads_.size(); i++) {
 		if (threads_[i]) threads_[i]->JoinWithStop();
 	}
@@ -412,6 +442,117 @@ bool utils::ThreadPool::WaitAndJoin() {
 	return true;
 }
 
+namespace utils {
+	//shared by the caller and the workers of one ThreadPool::Execute call
+	class ExecuteBatch {
+	public:
+		ExecuteBatch(const std::vector<ThreadCallback> &jobs)
+			: jobs_(jobs), total_(jobs.size()), next_(0), finished_(0) {}
+
+		//take the jobs one by one until no more left, return false if nothing was taken
+		bool RunJobs() {
+			bool taken = false;
+			while (true) {
+				size_t index = 0;
+				do {
+					MutexGuard guard(lock_);
+					index = next_++;
+				} while (false);
+
+				if (index >= total_) {
+					break;
+				}
+
+				//a throwing job is still counted, or the caller would wait forever
+				FinishGuard finish(this);
+				try {
+					jobs_[index]();
+				}
+				catch (...) {
+					MutexGuard guard(lock_);
+					if (!error_) {
+						error_ = std::current_exception();
+					}
+				}
+				taken = true;
+			}
+
+			return taken;
+		}
+
+		//wait for all the jobs, and throw the first exception of them on the caller
+		void Wait() {
+			done_.Wait();
+			if (error_) {
+				std::rethrow_exception(error_);
+			}
+		}
+
+	private:
+		class FinishGuard {
+		public:
+			FinishGuard(ExecuteBatch *batch) : batch_(batch) {}
+			~FinishGuard() {
+				batch_->Finish();
+			}
+		private:
+			ExecuteBatch *batch_;
+		};
+
+		void Finish() {
+			bool all_done = false;
+			do {
+				MutexGuard guard(lock_);
+				all_done = (++finished_ == total_);
+			} while (false);
+
+			if (all_done) {
+				done_.Signal();
+			}
+		}
+
+		const std::vector<ThreadCallback> &jobs_;
+		size_t total_;
+		size_t next_;
+		size_t finished_;
+		std::exception_ptr error_;
+		Mutex lock_;
+		Semaphore done_;
+	};
+
+	class ExecuteTask : public Runnable {
+	public:
+		ExecuteTask(std::shared_ptr<ExecuteBatch> batch) : batch_(batch) {}
+
+		virtual void Run(Thread *this_thread) {
+			batch_->RunJobs();
+			delete this;
+		}
+
+	private:
+		std::shared_ptr<ExecuteBatch> batch_;
+	};
+}
+
+void utils::ThreadPool::Execute(const std::vector<ThreadCallback> &jobs) {
+	if (jobs.empty()) {
+		return;
+	}
+
+	std::shared_ptr<ExecuteBatch> batch = std::make_shared<ExecuteBatch>(jobs);
+	size_t helper_count = MIN(threads_.size(), jobs.size() - 1);
+	if (!enabled_) {
+		helper_count = 0;
+	}
+
+	for (size_t i = 0; i < helper_count; i++) {
+		tasks_.Put(new ExecuteTask(batch));
+	}
+
+	batch->RunJobs();
+	batch->Wait();
+}
+
 bool utils::ThreadPool::WaitTaskComplete() {
 	while (tasks_.Size() > 0)
 		Sleep(1);
@@ -439,9 +580,10 @@ bool utils::ThreadPool::AddWorker(int threadNum) {
 
 void utils::ThreadPool::Run(Thread *this_thread) {
 	while (enabled_) {
+		//one wait for each signal of put or wake, an idle worker does not poll
+		tasks_.Wait();
 		utils::Runnable *task = tasks_.Get();
 		if (task) task->Run(this_thread);
-		else utils::Sleep(1);
 	}
 }
 
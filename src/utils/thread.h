@@ -287,6 +287,10 @@ namespace utils {
 		int Size();
 		Runnable *Get();
 
+		//block until a task is put or Wake is called
+		void Wait();
+		void Wake();
+
 	private:
 		UTILS_DISALLOW_EVIL_CONSTRUCTORS(ThreadTaskQueue);
 		typedef std::list<Runnable *> Tasks;
@@ -316,6 +320,10 @@ namespace utils {
 
 		bool WaitTaskComplete();
 
+		//run the jobs on the workers and return after all of them finished,
+		//the calling thread takes jobs as well, so it is safe to call from a worker
+		void Execute(const std::vector<ThreadCallback> &jobs);
+
 		//terminate
 		void Terminate();
 
@@ -325,6 +333,8 @@ namespace utils {
 
 		//add worker
 		bool AddWorker(int threadNum);
+		//run the tasks still queued after the workers stopped
+		void DrainTasks();
 
 		void Run(Thread *this_thread);
 
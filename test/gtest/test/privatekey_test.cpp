@@ -45,6 +45,90 @@ void sign_verify(){
     }
 }
 
+void verify_group(){
+    std::vector<std::string> datas, sigs, pubkeys;
+    for (int i = 0; i < 10; i++)
+    {
+        bumo::PrivateKey skey(bumo::SIGNTYPE_ED25519);
+        datas.push_back("hello" + std::to_string(i));
+        sigs.push_back(skey.Sign(datas.back()));
+        pubkeys.push_back(skey.GetEncPublicKey());
+    }
+
+    std::vector<bumo::SignatureEntry> entries;
+    for (size_t i = 0; i < datas.size(); i++){
+        entries.push_back(bumo::SignatureEntry(datas[i], sigs[i], pubkeys[i]));
+    }
+    std::vector<bool> valid;
+    ASSERT_EQ(bumo::PublicKey::VerifyGroup(entries, valid), true);
+    ASSERT_EQ(valid.size(), datas.size());
+
+    //a bad signature only fails its own entry
+    entries[3].signature_[0] ^= 0x01;
+    ASSERT_EQ(bumo::PublicKey::VerifyGroup(entries, valid), false);
+    for (size_t i = 0; i < valid.size(); i++){
+        ASSERT_EQ(valid[i], i != 3);
+    }
+}
+
+//S + l, the order of the base point, little endian
+static std::string add_order(const std::string &sig){
+    static const unsigned char order[32] = {
+        0xed, 0xd3, 0xf5, 0x5c, 0x1a, 0x63, 0x12, 0x58, 0xd6, 0x9c, 0xf7, 0xa2, 0xde, 0xf9, 0xde, 0x14,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10 };
+    std::string ret = sig;
+    int carry = 0;
+    for (int i = 0; i < 32; i++){
+        int sum = (unsigned char)ret[32 + i] + order[i] + carry;
+        ret[32 + i] = (char)(sum & 0xff);
+        carry = sum >> 8;
+    }
+    return ret;
+}
+
+void verify_group_malleated(){
+    std::vector<std::string> datas, sigs, pubkeys;
+    for (int i = 0; i < 64; i++)
+    {
+        bumo::PrivateKey skey(bumo::SIGNTYPE_ED25519);
+        datas.push_back("hello" + std::to_string(i));
+        std::string sig = skey.Sign(datas.back());
+        if (i % 3 == 1){
+            //malleated S, the single check decides whether it passes
+            sig = add_order(sig);
+        }
+        else if (i % 3 == 2){
+            //non canonical S, never valid
+            sig[63] |= 0x80;
+            ASSERT_EQ(bumo::PublicKey::Verify(datas.back(), sig, skey.GetEncPublicKey()), false);
+        }
+        sigs.push_back(sig);
+        pubkeys.push_back(skey.GetEncPublicKey());
+    }
+
+    std::vector<bumo::SignatureEntry> entries;
+    for (size_t i = 0; i < datas.size(); i++){
+        entries.push_back(bumo::SignatureEntry(datas[i], sigs[i], pubkeys[i]));
+    }
+
+    //the result of an entry is the single check, whatever the group it is in
+    for (size_t group = 1; group <= entries.size(); group *= 2){
+        for (size_t begin = 0; begin < entries.size(); begin += group){
+            std::vector<bumo::SignatureEntry> part(entries.begin() + begin, entries.begin() + std::min(begin + group, entries.size()));
+            std::vector<bool> valid;
+            bumo::PublicKey::VerifyGroup(part, valid);
+            ASSERT_EQ(valid.size(), part.size());
+            for (size_t i = 0; i < part.size(); i++){
+                size_t index = begin + i;
+                ASSERT_EQ(valid[i], bumo::PublicKey::Verify(datas[index], sigs[index], pubkeys[index]));
+                if (index % 3 == 2){
+                    ASSERT_EQ(valid[i], false);
+                }
+            }
+        }
+    }
+}
+
 void IsAddressValid(){
     bubi::PrivateKey priv_key(bubi::SIGNTYPE_ED25519);
     std::string public_key = priv_key.GetEncPublicKey();
@@ -73,6 +157,13 @@ TEST(sign_verify, sign_verify){
     sign_verify();
 }
 
+TEST(verify_group, verify_group){
+    verify_group();
+}
+
+TEST(verify_group, malleated){
+    verify_group_malleated();
+}
 
 TEST(IsAddressValid, IsAddressValid){
     IsAddressValid();
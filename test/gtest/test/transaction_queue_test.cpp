@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+#include "glue/transaction_queue.h"
+
+static bumo::TransactionFrm::pointer make_tx(const std::string &source, int64_t nonce, int64_t gas_price, const std::string &metadata = ""){
+    protocol::TransactionEnv env;
+    protocol::Transaction *tran = env.mutable_transaction();
+    tran->set_source_address(source);
+    tran->set_nonce(nonce);
+    tran->set_gas_price(gas_price);
+    tran->set_fee_limit(1000000);
+    tran->set_metadata(metadata);
+    return std::make_shared<bumo::TransactionFrm>(env, false);
+}
+
+static bool import_tx(bumo::TransactionQueue &queue, bumo::TransactionFrm::pointer tx, int64_t cur_nonce = 0){
+    bumo::Result result;
+    return queue.Import(tx, cur_nonce, result);
+}
+
+static std::vector<bumo::TransactionFrm::pointer> query(bumo::TransactionQueue &queue, uint32_t num){
+    std::vector<bumo::TransactionFrm::pointer> txs;
+    queue.Query(num, txs);
+    return txs;
+}
+
+TEST(transaction_queue, nonce_gap){
+    bumo::TransactionQueue queue(100, 10);
+    bumo::TransactionFrm::pointer a1 = make_tx("a", 1, 10);
+    bumo::TransactionFrm::pointer a3 = make_tx("a", 3, 10);
+    bumo::TransactionFrm::pointer b1 = make_tx("b", 1, 5);
+    ASSERT_TRUE(import_tx(queue, a1));
+    ASSERT_TRUE(import_tx(queue, a3));
+    ASSERT_TRUE(import_tx(queue, b1));
+
+    //a3 is older than b1, but it waits for a2
+    std::vector<bumo::TransactionFrm::pointer> txs = query(queue, 2);
+    ASSERT_EQ(txs.size(), (size_t)2);
+    ASSERT_EQ(txs[0], a1);
+    ASSERT_EQ(txs[1], b1);
+
+    //the gap is filled, the chain of a goes first by its gas price
+    bumo::TransactionFrm::pointer a2 = make_tx("a", 2, 10);
+    ASSERT_TRUE(import_tx(queue, a2));
+    txs = query(queue, 4);
+    ASSERT_EQ(txs.size(), (size_t)4);
+    ASSERT_EQ(txs[0], a1);
+    ASSERT_EQ(txs[1], a2);
+    ASSERT_EQ(txs[2], a3);
+    ASSERT_EQ(txs[3], b1);
+
+    //a nonce already used by the account is not the head
+    bumo::TransactionQueue used(100, 10);
+    ASSERT_TRUE(import_tx(used, make_tx("c", 1, 10), 1));
+    bumo::TransactionFrm::pointer d1 = make_tx("d", 1, 1);
+    ASSERT_TRUE(import_tx(used, d1));
+    txs = query(used, 1);
+    ASSERT_EQ(txs.size(), (size_t)1);
+    ASSERT_EQ(txs[0], d1);
+}
+
+TEST(transaction_queue, replace_by_gas_price){
+    bumo::TransactionQueue queue(100, 10);
+    bumo::TransactionFrm::pointer old_tx = make_tx("a", 1, 10);
+    ASSERT_TRUE(import_tx(queue, old_tx));
+
+    //the same or a lower gas price is discarded
+    bumo::Result result;
+    ASSERT_FALSE(queue.Import(make_tx("a", 1, 10, "same"), 0, result));
+    ASSERT_EQ(result.code(), protocol::ERRCODE_TX_INSERT_QUEUE_FAIL);
+    ASSERT_FALSE(import_tx(queue, make_tx("a", 1, 9)));
+    ASSERT_TRUE(queue.IsExist(old_tx->GetContentHash()));
+
+    bumo::TransactionFrm::pointer new_tx = make_tx("a", 1, 11);
+    ASSERT_TRUE(import_tx(queue, new_tx));
+    ASSERT_EQ(queue.Size(), (size_t)1);
+    ASSERT_FALSE(queue.IsExist(old_tx->GetContentHash()));
+    ASSERT_TRUE(queue.IsExist(new_tx->GetContentHash()));
+
+    std::vector<bumo::TransactionFrm::pointer> txs = query(queue, 10);
+    ASSERT_EQ(txs.size(), (size_t)1);
+    ASSERT_EQ(txs[0], new_tx);
+}
+
+TEST(transaction_queue, account_limit){
+    bumo::TransactionQueue queue(100, 2);
+    ASSERT_TRUE(import_tx(queue, make_tx("a", 1, 10)));
+    ASSERT_TRUE(import_tx(queue, make_tx("a", 2, 10)));
+    ASSERT_FALSE(import_tx(queue, make_tx("a", 3, 10)));
+    ASSERT_EQ(queue.Size(), (size_t)2);
+
+    //a replacement does not add to the account
+    bumo::TransactionFrm::pointer a2 = make_tx("a", 2, 20);
+    ASSERT_TRUE(import_tx(queue, a2));
+    ASSERT_EQ(queue.Size(), (size_t)2);
+    ASSERT_TRUE(queue.IsExist(a2));
+
+    //the other accounts have their own limit
+    ASSERT_TRUE(import_tx(queue, make_tx("b", 1, 10)));
+    ASSERT_EQ(queue.Size(), (size_t)3);
+}
+
+TEST(transaction_queue, evict_lowest){
+    bumo::TransactionQueue queue(3, 10);
+    bumo::TransactionFrm::pointer a1 = make_tx("a", 1, 10);
+    bumo::TransactionFrm::pointer b1 = make_tx("b", 1, 5);
+    bumo::TransactionFrm::pointer c1 = make_tx("c", 1, 20);
+    ASSERT_TRUE(import_tx(queue, a1));
+    ASSERT_TRUE(import_tx(queue, b1));
+    ASSERT_TRUE(import_tx(queue, c1));
+
+    //the full queue drops the lowest gas price of all accounts
+    bumo::TransactionFrm::pointer d1 = make_tx("d", 1, 15);
+    ASSERT_TRUE(import_tx(queue, d1));
+    ASSERT_EQ(queue.Size(), (size_t)3);
+    ASSERT_FALSE(queue.IsExist(b1));
+    ASSERT_TRUE(queue.IsExist(a1));
+
+    //a new transaction lower than all is dropped itself
+    bumo::Result result;
+    bumo::TransactionFrm::pointer e1 = make_tx("e", 1, 1);
+    ASSERT_FALSE(queue.Import(e1, 0, result));
+    ASSERT_EQ(result.code(), protocol::ERRCODE_TX_INSERT_QUEUE_FAIL);
+    ASSERT_FALSE(queue.IsExist(e1));
+    ASSERT_EQ(queue.Size(), (size_t)3);
+}
+
+TEST(transaction_queue, evict_tail){
+    //the last transaction of an account is dropped, its executable head is kept
+    bumo::TransactionQueue queue(3, 10);
+    bumo::TransactionFrm::pointer a1 = make_tx("a", 1, 30);
+    bumo::TransactionFrm::pointer a2 = make_tx("a", 2, 2);
+    bumo::TransactionFrm::pointer b1 = make_tx("b", 1, 10);
+    ASSERT_TRUE(import_tx(queue, a1));
+    ASSERT_TRUE(import_tx(queue, a2));
+    ASSERT_TRUE(import_tx(queue, b1));
+
+    bumo::TransactionFrm::pointer c1 = make_tx("c", 1, 20);
+    ASSERT_TRUE(import_tx(queue, c1));
+    ASSERT_EQ(queue.Size(), (size_t)3);
+    ASSERT_TRUE(queue.IsExist(a1));
+    ASSERT_FALSE(queue.IsExist(a2));
+    ASSERT_TRUE(queue.IsExist(b1));
+    ASSERT_TRUE(queue.IsExist(c1));
+
+    std::vector<bumo::TransactionFrm::pointer> txs = query(queue, 10);
+    ASSERT_EQ(txs.size(), (size_t)3);
+    ASSERT_EQ(txs[0], a1);
+    ASSERT_EQ(txs[1], c1);
+    ASSERT_EQ(txs[2], b1);
+}
@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include "ledger/trie.h"
+
+//the location of the nibbles, as the trie keeps them
+static bumo::Location make_location(const std::vector<uint8_t> &nibbles){
+    bumo::Location location;
+    location.push_back(nibbles.size() % 2 == 0 ? bumo::Trie::EVEN_PREFIX : bumo::Trie::ODD_PREFIX);
+    for (size_t i = 0; i < nibbles.size(); i += 2){
+        uint8_t ch = nibbles[i] << 4;
+        if (i + 1 < nibbles.size()){
+            ch |= nibbles[i + 1];
+        }
+        location.push_back((char)ch);
+    }
+    return location;
+}
+
+static protocol::Node make_empty_node(){
+    protocol::Node node;
+    for (int i = 0; i < 17; i++){
+        node.add_children();
+    }
+    return node;
+}
+
+static void set_child(protocol::Node &node, int branch, protocol::CHILDTYPE type,
+    const bumo::Location &sublocation, const std::string &hash){
+    protocol::Child *chd = node.mutable_children(branch);
+    chd->set_childtype(type);
+    chd->set_sublocation(sublocation);
+    chd->set_hash(hash);
+}
+
+static void round_trip(const bumo::Location &location, const protocol::Node &node){
+    std::string buff = bumo::Trie::EncodeNode(location, node);
+    protocol::Node decoded;
+    ASSERT_TRUE(bumo::Trie::DecodeNode(location, buff, decoded));
+    //the hash is taken on the protobuf, so it must come back byte for byte
+    ASSERT_EQ(node.SerializeAsString(), decoded.SerializeAsString());
+}
+
+TEST(trie_node, empty){
+    protocol::Node node = make_empty_node();
+    std::string buff = bumo::Trie::EncodeNode(make_location({ 1, 2 }), node);
+    ASSERT_EQ(buff.size(), (size_t)4);
+    round_trip(make_location({ 1, 2 }), node);
+}
+
+TEST(trie_node, inner_relative){
+    //the children below the parent on their branch, both odd and even lengths
+    std::vector<uint8_t> parent = { 3, 4, 5 };
+    protocol::Node node = make_empty_node();
+    set_child(node, 0, protocol::INNER, make_location({ 3, 4, 5, 0 }), std::string(32, 'a'));
+    set_child(node, 7, protocol::INNER, make_location({ 3, 4, 5, 7, 9 }), std::string(32, 'b'));
+    set_child(node, 15, protocol::INNER, make_location({ 3, 4, 5, 15, 1, 2, 3, 4, 5, 6 }), std::string(32, 'c'));
+    round_trip(make_location(parent), node);
+
+    //the compact form is smaller than the protobuf one
+    ASSERT_LT(bumo::Trie::EncodeNode(make_location(parent), node).size(), node.SerializeAsString().size());
+}
+
+TEST(trie_node, leaf){
+    bumo::Location location = make_location({ 6, 1 });
+    protocol::Node node = make_empty_node();
+    //the value of the node itself
+    set_child(node, 16, protocol::LEAF, location, std::string(32, 'd'));
+    set_child(node, 2, protocol::LEAF, make_location({ 6, 1, 2, 8, 8, 8, 8 }), std::string(32, 'e'));
+    round_trip(location, node);
+}
+
+TEST(trie_node, absolute){
+    bumo::Location location = make_location({ 2, 2 });
+    protocol::Node node = make_empty_node();
+    //not below the parent, or not on its branch, the location is kept as it is
+    set_child(node, 1, protocol::INNER, make_location({ 9, 9, 9 }), std::string(32, 'f'));
+    set_child(node, 3, protocol::LEAF, make_location({ 2, 2, 4, 1 }), std::string(32, 'g'));
+    set_child(node, 16, protocol::LEAF, make_location({ 2, 2, 0 }), std::string(32, 'h'));
+    //an odd location with a dirty low nibble is not the one the nibbles give back
+    bumo::Location dirty = make_location({ 2, 2, 5 });
+    dirty[dirty.size() - 1] |= 0x0f;
+    set_child(node, 5, protocol::INNER, dirty, std::string(32, 'i'));
+    round_trip(location, node);
+}
+
+TEST(trie_node, variable_hash){
+    bumo::Location location = make_location({});
+    protocol::Node node = make_empty_node();
+    set_child(node, 4, protocol::INNER, make_location({ 4 }), std::string(20, 'j'));
+    set_child(node, 8, protocol::INNER, make_location({ 8, 1 }), "");
+    set_child(node, 9, protocol::NONE, "", std::string(64, 'k'));
+    round_trip(location, node);
+}
+
+TEST(trie_node, protobuf_fallback){
+    //a node the compact encoding can't hold is stored as protobuf
+    protocol::Node node;
+    node.add_children();
+    set_child(node, 0, protocol::INNER, make_location({ 1 }), std::string(32, 'l'));
+    std::string buff = bumo::Trie::EncodeNode(make_location({}), node);
+    ASSERT_EQ(buff, node.SerializeAsString());
+    round_trip(make_location({}), node);
+}
+
+TEST(trie_node, legacy){
+    //the nodes written before the compact encoding are protobuf
+    bumo::Location location = make_location({ 7 });
+    protocol::Node node = make_empty_node();
+    set_child(node, 0, protocol::INNER, make_location({ 7, 0, 1 }), std::string(32, 'm'));
+    set_child(node, 16, protocol::LEAF, location, std::string(32, 'n'));
+
+    protocol::Node decoded;
+    ASSERT_TRUE(bumo::Trie::DecodeNode(location, node.SerializeAsString(), decoded));
+    ASSERT_EQ(node.SerializeAsString(), decoded.SerializeAsString());
+
+    //an empty buffer is an empty legacy node
+    ASSERT_TRUE(bumo::Trie::DecodeNode(location, "", decoded));
+    ASSERT_EQ(decoded.children_size(), 0);
+}
+
+TEST(trie_node, truncated){
+    bumo::Location location = make_location({ 3, 4, 5 });
+    protocol::Node node = make_empty_node();
+    set_child(node, 7, protocol::INNER, make_location({ 3, 4, 5, 7, 9 }), std::string(32, 'o'));
+    std::string buff = bumo::Trie::EncodeNode(location, node);
+
+    protocol::Node decoded;
+    for (size_t i = 1; i < buff.size(); i++){
+        ASSERT_FALSE(bumo::Trie::DecodeNode(location, buff.substr(0, i), decoded));
+    }
+    ASSERT_FALSE(bumo::Trie::DecodeNode(location, buff + "x", decoded));
+}